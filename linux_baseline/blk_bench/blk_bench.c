@@ -0,0 +1,203 @@
+/*
+ * Copyright 2025
+ * Linux Block I/O Benchmark (equivalent to seL4 Microkit virtio_blk/blk_bench)
+ *
+ * Same sweep and output as the Microkit benchmark: random block-aligned
+ * writes then reads for each block size and queue depth. Queue depth is
+ * emulated with one thread per outstanding request doing pread/pwrite,
+ * which is how a synchronous client reaches that depth on Linux.
+ *
+ * Usage: ./blk_bench [--direct] [file]
+ *   --direct  open with O_DIRECT to bypass the page cache
+ *   file      disk image or block device (default /tmp/sel4_linux_disk.img,
+ *             created at 64 MiB if missing)
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+
+#define DEFAULT_DISK "/tmp/sel4_linux_disk.img"
+#define DEFAULT_DISK_SIZE (64ULL << 20)
+#define SECTOR_SIZE 512
+
+static const uint32_t block_sizes[] = { 512, 4096, 16384, 65536 };
+static const uint32_t queue_depths[] = { 1, 4, 16, 32 };
+
+#define NUM_SIZES (sizeof(block_sizes) / sizeof(block_sizes[0]))
+#define NUM_DEPTHS (sizeof(queue_depths) / sizeof(queue_depths[0]))
+
+/* Same per-run sizing as blk_bench.c */
+#define BYTES_PER_RUN (8 << 20)
+#define MIN_IOS 256
+#define MAX_IOS 4096
+
+struct worker {
+    pthread_t thread;
+    int fd;
+    int write;
+    uint32_t bs;
+    uint32_t ios;
+    uint64_t blocks;
+    uint64_t rng;
+    void *buf;
+    uint64_t latency_ns;
+    uint32_t errors;
+};
+
+static uint64_t get_timestamp_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t next_random(uint64_t *state)
+{
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *state >> 11;
+}
+
+static void *worker_main(void *arg)
+{
+    struct worker *w = arg;
+
+    for (uint32_t i = 0; i < w->ios; i++) {
+        off_t off = (off_t)(next_random(&w->rng) % w->blocks) * w->bs;
+        uint64_t start = get_timestamp_ns();
+        ssize_t n = w->write ? pwrite(w->fd, w->buf, w->bs, off) : pread(w->fd, w->buf, w->bs, off);
+        w->latency_ns += get_timestamp_ns() - start;
+        if (n != (ssize_t)w->bs) {
+            w->errors++;
+        }
+    }
+    return NULL;
+}
+
+static int run(int fd, uint64_t capacity, int write, uint32_t bs, uint32_t qd)
+{
+    struct worker workers[32];
+    uint32_t total = BYTES_PER_RUN / bs;
+
+    if (total < MIN_IOS) {
+        total = MIN_IOS;
+    } else if (total > MAX_IOS) {
+        total = MAX_IOS;
+    }
+
+    for (uint32_t i = 0; i < qd; i++) {
+        struct worker *w = &workers[i];
+        memset(w, 0, sizeof(*w));
+        w->fd = fd;
+        w->write = write;
+        w->bs = bs;
+        w->ios = total / qd + (i < total % qd);
+        w->blocks = capacity / bs;
+        w->rng = 0x9e3779b97f4a7c15ULL + i;
+        if (posix_memalign(&w->buf, 4096, bs) != 0) {
+            fprintf(stderr, "Error: out of memory\n");
+            return -1;
+        }
+        memset(w->buf, 0xa5, bs);
+    }
+
+    uint64_t start = get_timestamp_ns();
+    for (uint32_t i = 0; i < qd; i++) {
+        pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]);
+    }
+
+    uint64_t latency_ns = 0;
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < qd; i++) {
+        pthread_join(workers[i].thread, NULL);
+        latency_ns += workers[i].latency_ns;
+        errors += workers[i].errors;
+        free(workers[i].buf);
+    }
+    uint64_t ns = get_timestamp_ns() - start;
+    if (ns == 0) {
+        ns = 1;
+    }
+
+    printf("BLKBENCH|METRIC: op=%s bs=%u qd=%u ios=%u errors=%u iops=%llu mb_per_s=%llu avg_lat_us=%llu\n",
+           write ? "write" : "read", bs, qd, total, errors,
+           (unsigned long long)((uint64_t)total * 1000000000ULL / ns),
+           (unsigned long long)((uint64_t)total * bs * 1000ULL / ns),
+           (unsigned long long)(latency_ns / total / 1000));
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = DEFAULT_DISK;
+    int flags = O_RDWR;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--direct") == 0) {
+            flags |= O_DIRECT;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    int fd = open(path, flags);
+    if (fd < 0 && errno == ENOENT && strcmp(path, DEFAULT_DISK) == 0) {
+        fd = open(path, flags | O_CREAT, 0644);
+        if (fd >= 0 && ftruncate(fd, DEFAULT_DISK_SIZE) < 0) {
+            perror("ftruncate");
+            return 1;
+        }
+    }
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+
+    struct stat st;
+    uint64_t capacity;
+    if (fstat(fd, &st) < 0) {
+        perror("fstat");
+        return 1;
+    }
+    if (S_ISBLK(st.st_mode)) {
+        if (ioctl(fd, BLKGETSIZE64, &capacity) < 0) {
+            perror("BLKGETSIZE64");
+            return 1;
+        }
+    } else {
+        capacity = st.st_size;
+    }
+
+    if (capacity < block_sizes[NUM_SIZES - 1]) {
+        fprintf(stderr, "Error: %s is smaller than the largest block size\n", path);
+        return 1;
+    }
+
+    printf("BLKBENCH|INFO: starting capacity_sectors=%llu direct=%d\n",
+           (unsigned long long)(capacity / SECTOR_SIZE), (flags & O_DIRECT) != 0);
+
+    for (unsigned s = 0; s < NUM_SIZES; s++) {
+        for (unsigned q = 0; q < NUM_DEPTHS; q++) {
+            if (run(fd, capacity, 1, block_sizes[s], queue_depths[q]) < 0 ||
+                run(fd, capacity, 0, block_sizes[s], queue_depths[q]) < 0) {
+                return 1;
+            }
+        }
+    }
+
+    printf("BLKBENCH|INFO: done\n");
+    close(fd);
+    return 0;
+}
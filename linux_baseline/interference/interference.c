@@ -0,0 +1,276 @@
+/*
+ * Copyright 2025
+ * Linux Interference Benchmark (equivalent to seL4 Microkit interference/bench)
+ *
+ * Same loads, sampling and output as the Microkit benchmark, with
+ * processes in place of PDs: a server process answers requests on a
+ * socket pair (the protected call) and echoes eventfd signals (the
+ * notification round trip), while one load process at a time runs
+ * alongside. Everything is pinned to one CPU by default, as the Microkit
+ * system runs on a single core.
+ *
+ * Usage: ./interference [--cpu N] [--nice N] [--period-us N]
+ *   --cpu N        CPU to pin every process to, -1 to leave them unpinned (default 0)
+ *   --nice N       nice value of the load processes (default 10, i.e. below the benchmark)
+ *   --period-us N  time between samples (default 200)
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define SAMPLES 2000
+
+/* Same sizes as the Microkit loads' regions */
+#define LOAD_BUFFER_SIZE (8 << 20)
+#define LINE_SIZE 64
+#define CHUNK_SIZE 0x10000
+
+enum load { LOAD_NONE, LOAD_CACHE_THRASH, LOAD_MEMBW, LOAD_SYSCALL_STORM, NUM_LOADS };
+
+static const char *const load_names[] = { "none", "cache_thrash", "membw", "syscall_storm" };
+
+/* Shared with the load processes */
+struct control {
+    volatile uint64_t iterations[NUM_LOADS];
+};
+
+static struct control *control;
+
+static uint64_t get_timestamp_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void pin(int cpu)
+{
+    if (cpu < 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) < 0) {
+        perror("sched_setaffinity");
+        exit(1);
+    }
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report(enum load load, const char *op, uint64_t *samples, uint64_t iterations)
+{
+    uint64_t sum = 0;
+
+    qsort(samples, SAMPLES, sizeof(samples[0]), cmp_u64);
+    for (unsigned i = 0; i < SAMPLES; i++) {
+        sum += samples[i];
+    }
+
+    printf("INTERFERENCE|METRIC: load=%s op=%s samples=%u load_iterations=%llu min_ns=%llu p50_ns=%llu "
+           "p99_ns=%llu p999_ns=%llu max_ns=%llu avg_ns=%llu\n",
+           load_names[load], op, SAMPLES, (unsigned long long)iterations,
+           (unsigned long long)samples[0],
+           (unsigned long long)samples[SAMPLES / 2],
+           (unsigned long long)samples[SAMPLES * 99 / 100],
+           (unsigned long long)samples[SAMPLES * 999 / 1000],
+           (unsigned long long)samples[SAMPLES - 1],
+           (unsigned long long)(sum / SAMPLES));
+    fflush(stdout);
+}
+
+static void server_main(int sock, int notify_in, int notify_out)
+{
+    for (;;) {
+        uint8_t req;
+        uint64_t val;
+
+        /* Requests and notifications strictly alternate, as the benchmark sends them */
+        if (read(sock, &req, 1) != 1) {
+            exit(0);
+        }
+        if (write(sock, &req, 1) != 1) {
+            exit(1);
+        }
+        if (read(notify_in, &val, sizeof(val)) != sizeof(val)) {
+            exit(1);
+        }
+        if (write(notify_out, &val, sizeof(val)) != sizeof(val)) {
+            exit(1);
+        }
+    }
+}
+
+static void load_main(enum load load)
+{
+    uint8_t *buf = NULL;
+
+    if (load != LOAD_SYSCALL_STORM) {
+        buf = mmap(NULL, LOAD_BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf == MAP_FAILED) {
+            perror("mmap");
+            exit(1);
+        }
+        memset(buf, 0, LOAD_BUFFER_SIZE);
+    }
+
+    /* Runs until the benchmark kills it */
+    for (;;) {
+        switch (load) {
+            case LOAD_CACHE_THRASH:
+                for (size_t off = 0; off < LOAD_BUFFER_SIZE; off += LINE_SIZE) {
+                    volatile uint64_t *line = (volatile uint64_t *)(buf + off);
+                    *line = *line + 1;
+                }
+                break;
+            case LOAD_MEMBW:
+                for (size_t off = 0; off < LOAD_BUFFER_SIZE / 2; off += CHUNK_SIZE) {
+                    memcpy(buf + LOAD_BUFFER_SIZE / 2 + off, buf + off, CHUNK_SIZE);
+                    __asm__ volatile("" ::: "memory");
+                }
+                break;
+            case LOAD_SYSCALL_STORM:
+                sched_yield();
+                break;
+            default:
+                exit(0);
+        }
+        control->iterations[load]++;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int cpu = 0;
+    int load_nice = 10;
+    uint64_t period_ns = 200 * 1000ULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cpu") == 0 && i + 1 < argc) {
+            cpu = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--nice") == 0 && i + 1 < argc) {
+            load_nice = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--period-us") == 0 && i + 1 < argc) {
+            period_ns = strtoull(argv[++i], NULL, 0) * 1000ULL;
+        } else {
+            fprintf(stderr, "Usage: %s [--cpu N] [--nice N] [--period-us N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    control = mmap(NULL, sizeof(*control), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (control == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    int socks[2];
+    int notify_to_server = eventfd(0, 0);
+    int notify_to_bench = eventfd(0, 0);
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, socks) < 0 || notify_to_server < 0 || notify_to_bench < 0) {
+        perror("socketpair/eventfd");
+        return 1;
+    }
+
+    pin(cpu);
+
+    pid_t server = fork();
+    if (server < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (server == 0) {
+        close(socks[0]);
+        server_main(socks[1], notify_to_server, notify_to_bench);
+    }
+    close(socks[1]);
+
+    printf("INTERFERENCE|INFO: starting cpu=%d load_nice=%d sample_period_us=%llu\n",
+           cpu, load_nice, (unsigned long long)(period_ns / 1000));
+    fflush(stdout);
+
+    static uint64_t ppcall_samples[SAMPLES];
+    static uint64_t notify_samples[SAMPLES];
+
+    for (enum load load = LOAD_NONE; load < NUM_LOADS; load++) {
+        pid_t loader = -1;
+        uint64_t start_iterations = control->iterations[load];
+
+        if (load != LOAD_NONE) {
+            loader = fork();
+            if (loader < 0) {
+                perror("fork");
+                return 1;
+            }
+            if (loader == 0) {
+                if (setpriority(PRIO_PROCESS, 0, load_nice) < 0) {
+                    perror("setpriority");
+                }
+                load_main(load);
+            }
+        }
+
+        struct timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+
+        for (unsigned i = 0; i < SAMPLES; i++) {
+            uint64_t val = 1;
+            uint8_t req = 0;
+
+            next.tv_nsec += period_ns;
+            while (next.tv_nsec >= 1000000000L) {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+            uint64_t start = get_timestamp_ns();
+            if (write(socks[0], &req, 1) != 1 || read(socks[0], &req, 1) != 1) {
+                perror("server call");
+                return 1;
+            }
+            ppcall_samples[i] = get_timestamp_ns() - start;
+
+            start = get_timestamp_ns();
+            if (write(notify_to_server, &val, sizeof(val)) != sizeof(val) ||
+                read(notify_to_bench, &val, sizeof(val)) != sizeof(val)) {
+                perror("notify");
+                return 1;
+            }
+            notify_samples[i] = get_timestamp_ns() - start;
+        }
+
+        if (loader > 0) {
+            kill(loader, SIGKILL);
+            waitpid(loader, NULL, 0);
+        }
+
+        uint64_t iterations = control->iterations[load] - start_iterations;
+        report(load, "ppcall", ppcall_samples, iterations);
+        report(load, "notify_rtt", notify_samples, iterations);
+    }
+
+    close(socks[0]);
+    waitpid(server, NULL, 0);
+    printf("INTERFERENCE|INFO: done\n");
+    return 0;
+}
@@ -6,6 +6,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <microkit.h>
+#include "memops.h"
+#include "inet_csum.h"
+#include "pkt_ring.h"
 
 #define OUTPUT_CH 1 /* output from this PD -- becomes input for peer */
 #define INPUT_CH 2 /* intput to this PD -- comes from peer output */
@@ -38,8 +41,9 @@ static uint8_t my_ip[4] = { 10, 141, 2, 80 };
 
 static uint8_t temp_packet[PACKET_BUFFER_SIZE] __attribute__((aligned(64)));
 
-static unsigned output_index = 0;
-static unsigned input_index = 0;
+/* Free-running ring indices; the slot is the index modulo BUFFER_MAX */
+static uint32_t output_tail = 0;
+static uint32_t input_head = 0;
 
 
 /* A small selection of ehtertype that we might see
@@ -55,9 +59,13 @@ static unsigned input_index = 0;
 
 uint64_t output_buffer_vaddr;
 uint64_t input_buffer_vaddr;
+uint64_t output_ring_vaddr;
+uint64_t input_ring_vaddr;
 
 #define OUTPUT_BUFFER output_buffer_vaddr
 #define INPUT_BUFFER input_buffer_vaddr
+#define OUTPUT_RING ((volatile struct pkt_ring *)(uintptr_t)output_ring_vaddr)
+#define INPUT_RING ((volatile struct pkt_ring *)(uintptr_t)input_ring_vaddr)
 
 
 static inline uint64_t
@@ -72,9 +80,9 @@ get_sys_counter(void)
     return r;
 }
 
+/* Header of each channel buffer slot; ownership is tracked by the pkt_ring indices */
 struct buffer_descriptor {
     uint16_t data_length;
-    uint16_t flags;
 };
 
 struct rbd {
@@ -440,28 +448,6 @@ ethertype_to_str(uint16_t ethertype)
     return "<unknown ether type>";
 }
 
-uint16_t
-cksum(uint8_t *d, int len)
-{
-    uint32_t sum = 0;  /* assume 32 bit long, 16 bit short */
-
-    while (len > 1) {
-        sum += * ((uint16_t *) d);
-        d += 2;
-        len -= 2;
-    }
-
-    if (len > 0) {       /* take care of left over byte */
-        sum += (uint16_t) *d;
-    }
-
-    while (sum >> 16) {
-        sum = (sum & 0xFFFF) + (sum >> 16);
-    }
-
-    return ~sum;
-}
-
 static void
 get_mac_addr(volatile struct regs *reg, uint8_t *mac)
 {
@@ -539,31 +525,6 @@ dump_hex(const uint8_t *d, unsigned int length)
     }
 }
 
-/* NOTE: This assumes we are copying to / from packet buffers, so we know we can doing unrolled copies */
-static void
-mycpy(void *dst, void *src, unsigned int length)
-{
-    uint64_t *d = dst;
-    uint64_t *s = src;
-    int i = 0;
-    int l = length / 64;
-    if (length % 64) {
-        l++;
-    }
-    while (l) {
-        d[i] = s[i];
-        d[i + 1] = s[i + 1];
-        d[i + 2] = s[i + 2];
-        d[i + 3] = s[i + 3];
-        d[i + 4] = s[i + 4];
-        d[i + 5] = s[i + 5];
-        d[i + 6] = s[i + 6];
-        d[i + 7] = s[i + 7];
-        l--;
-        i += 8;
-    }
-}
-
 static int
 mycmp(char *a, char *b) {
     int i = 0;
@@ -605,7 +566,7 @@ send_frame(uint8_t *d, unsigned int length)
 #endif
 
     packet = (void *)(uintptr_t)(packet_buffer_vaddr + ((RBD_COUNT + tbd_index) * PACKET_BUFFER_SIZE));
-    mycpy(packet, d, length);
+    memcpy(packet, d, length);
     seL4_ARM_VSpace_CleanInvalidate_Data(3, (uintptr_t)packet, ((uintptr_t)packet) + length);
 
     flags = (
@@ -707,6 +668,7 @@ handle_rx(microkit_channel ch, volatile struct regs *eth)
 {
     uint16_t flags;
     int r;
+    bool produced = false;
 
     /* received at least one frame, iterate through all recieve descriptor buffers */
     for (;;) {
@@ -836,7 +798,7 @@ handle_rx(microkit_channel ch, volatile struct regs *eth)
         #if 0
                             microkit_dbg_puts("HELP: ARP packet we should reply to\n");
         #endif
-                            mycpy(temp_packet, packet,  rbd[rbd_index].data_length);
+                            memcpy(temp_packet, packet, rbd[rbd_index].data_length);
 
                             struct eth_header *snd_hdr = (struct eth_header *)&temp_packet;
                             /* set the MAC addresses */
@@ -894,7 +856,7 @@ handle_rx(microkit_channel ch, volatile struct regs *eth)
         #if 0
                                 microkit_dbg_puts("ICMP ECHO REQUEST\n");
         #endif
-                                mycpy(temp_packet, packet,  rbd[rbd_index].data_length);
+                                memcpy(temp_packet, packet, rbd[rbd_index].data_length);
 
                                 struct eth_header *snd_hdr = (struct eth_header *)&temp_packet;
                                 /* set the MAC addresses */
@@ -907,11 +869,12 @@ handle_rx(microkit_channel ch, volatile struct regs *eth)
 
                                 struct icmp *snd_icmp = (struct icmp *)(&snd_hdr->payload[header_len]);
 
-                                /* Set reply */
+                                /* Set reply. Only the type changes, so patch the
+                                 * checksum (RFC 1624) instead of summing the payload again. */
+                                uint16_t old_type_code = *(uint16_t *)snd_icmp;
                                 snd_icmp->type = 0;
 
-                                snd_icmp->checksum = 0;
-                                snd_icmp->checksum = cksum((uint8_t *) snd_icmp, swap16(i->len) - header_len);//sizeof(struct icmp));
+                                snd_icmp->checksum = csum_update16(snd_icmp->checksum, old_type_code, *(uint16_t *)snd_icmp);
         #if 0
                                 microkit_dbg_puts("CHECKSUM: ");
                                 puthex16(snd_icmp->checksum);
@@ -931,22 +894,19 @@ handle_rx(microkit_channel ch, volatile struct regs *eth)
 #endif
 
         if (pass_through) {
-            /* Try and send */
-            volatile struct buffer_descriptor *bd = (void *)(uintptr_t)(OUTPUT_BUFFER + (BUFFER_SIZE * output_index));
-            volatile void *output_packet = (void *)(uintptr_t)(OUTPUT_BUFFER + (BUFFER_SIZE * output_index) + DATA_OFFSET);
-            if (bd->flags == 1) {
+            /* Try and send; the peer is told once the whole batch is in */
+            unsigned slot = output_tail % BUFFER_MAX;
+            volatile struct buffer_descriptor *bd = (void *)(uintptr_t)(OUTPUT_BUFFER + (BUFFER_SIZE * slot));
+            volatile void *output_packet = (void *)(uintptr_t)(OUTPUT_BUFFER + (BUFFER_SIZE * slot) + DATA_OFFSET);
+            if (output_tail - pkt_ring_head(OUTPUT_RING) == BUFFER_MAX) {
                 microkit_dbg_puts("ETH: ");
                 microkit_dbg_puts(microkit_name);
                 microkit_dbg_puts("dropping packet, no space in channel buffer\n");
             } else {
                 bd->data_length = rbd[rbd_index].data_length - 4; /* For the frame check sequence */
-                mycpy((void *)output_packet, packet, bd->data_length);
-                bd->flags = 1;
-                output_index++;
-                if (output_index == BUFFER_MAX) {
-                    output_index = 0;
-                }
-                microkit_notify(OUTPUT_CH);
+                memcpy((void *)output_packet, packet, bd->data_length);
+                output_tail++;
+                produced = true;
             }
         }
 
@@ -964,6 +924,11 @@ make_avail:
         }
     }
 
+    if (produced) {
+        pkt_ring_publish(OUTPUT_RING, output_tail);
+        microkit_notify(OUTPUT_CH);
+    }
+
     /* kick the rx engine if necessary */
     eth->rdar = (1 << 24);
 }
@@ -1032,34 +997,38 @@ notified(microkit_channel ch)
             handle_eth(ch, eth);
             break;
 
-        case INPUT_CH:
+        case INPUT_CH: {
 #if 0
             microkit_dbg_puts("ETH: ");
             microkit_dbg_puts(microkit_name);
             microkit_dbg_puts("  got input notification\n");
 #endif
-            for (;;) {
-                volatile struct buffer_descriptor *bd = (void *)(uintptr_t)(INPUT_BUFFER + (BUFFER_SIZE * input_index));
-                volatile void *pkt = (void *)(uintptr_t)(INPUT_BUFFER + (BUFFER_SIZE * input_index) + DATA_OFFSET);
-                if (bd->flags == 0) {
-                    break;
-                }
+            uint32_t input_tail = pkt_ring_tail(INPUT_RING);
+            if (input_head == input_tail) {
+                break;
+            }
+            while (input_head != input_tail) {
+                unsigned slot = input_head % BUFFER_MAX;
+                volatile struct buffer_descriptor *bd = (void *)(uintptr_t)(INPUT_BUFFER + (BUFFER_SIZE * slot));
+                volatile void *pkt = (void *)(uintptr_t)(INPUT_BUFFER + (BUFFER_SIZE * slot) + DATA_OFFSET);
 #if 0
                 microkit_dbg_puts("ETH: packet: ");
-                puthex16(input_index);
+                puthex16(slot);
                 microkit_dbg_puts("packet length: ");
                 puthex16(bd->data_length);
                 microkit_dbg_puts("\n");
 #endif
                 send_frame((void*)pkt, bd->data_length);
-                bd->flags = 0;
+                input_head++;
+            }
 
-                input_index++;
-                if (input_index == BUFFER_MAX) {
-                    input_index = 0;
-                }
+            /* Return the whole batch at once; in zero-copy mode the slots belong to our peer */
+            pkt_ring_release(INPUT_RING, input_head);
+            if (INPUT_RING->notify_on_release) {
+                microkit_notify(INPUT_CH);
             }
             break;
+        }
 
         case OUTPUT_CH:
 #if 0
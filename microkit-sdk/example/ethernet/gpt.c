@@ -3,9 +3,9 @@
  *
  * SPDX-License-Identifier: BSD-2-Clause
  */
-#include <stdbool.h>
 #include <stdint.h>
 #include <microkit.h>
+#include "timeout_heap.h"
 
 #define IRQ_CH 3
 
@@ -14,12 +14,20 @@ uintptr_t gpt_regs_clk;
 static volatile uint32_t *gpt;
 static volatile uint32_t *lpcg;
 
-static uint64_t timeouts[MICROKIT_MAX_CHANNELS];
-static microkit_channel active_channel = -1;
-static bool timeout_active;
-static uint64_t current_timeout;
 static uint32_t overflow_count;
-static uint8_t pending_timeouts;
+
+/* Pending timeouts, as absolute 64-bit tick deadlines */
+static struct timeout_heap timeouts;
+
+/*
+ * The compare is programmed this many ticks after the earliest deadline,
+ * and every timeout that is due when it fires is delivered together, so
+ * clients whose deadlines fall within the window share one interrupt.
+ * A timeout is delivered at most TIMEOUT_SLACK ticks late and never early.
+ */
+#ifndef TIMEOUT_SLACK
+#define TIMEOUT_SLACK 0x100
+#endif
 
 #define CR 0
 #define PR 1
@@ -32,6 +40,10 @@ static uint8_t pending_timeouts;
 #define ICR2 8
 #define CNT 9
 
+#define SR_ROV (1 << 5)
+#define IR_OF1IE (1 << 0)
+#define IR_ROVIE (1 << 5)
+
 static char
 hexchar(unsigned int v)
 {
@@ -56,6 +68,67 @@ puthex32(uint32_t x)
     microkit_dbg_puts(buffer);
 }
 
+/*
+ * The IRQ handler is the only place overflow_count advances, and this PD
+ * is single threaded, so a rollover that has happened but not yet been
+ * handled shows up as SR.ROV still being set. Count it here so time never
+ * goes backwards between the wrap and the interrupt.
+ */
+static uint64_t
+get_ticks(void)
+{
+    uint64_t overflow = overflow_count;
+    uint32_t sr1 = gpt[SR];
+    uint32_t cnt = gpt[CNT];
+    uint32_t sr2 = gpt[SR];
+    if (sr2 & SR_ROV) {
+        if (!(sr1 & SR_ROV)) {
+            /* wrapped between the two status reads; cnt may be pre-wrap */
+            cnt = gpt[CNT];
+        }
+        overflow++;
+    }
+    return (overflow << 32) | cnt;
+}
+
+/*
+ * Deliver every expired timeout, then program the compare for the next
+ * one. The compare only matches the low 32 bits, so a deadline in a later
+ * counter epoch is left to the rollover interrupt, which calls back here.
+ * If the counter passes the target while it is being programmed the
+ * match would be missed, so check and go round again.
+ */
+static void
+expire_and_rearm(void)
+{
+    for (;;) {
+        uint64_t now = get_ticks();
+
+        while (!timeout_heap_empty(&timeouts) && timeout_heap_min(&timeouts)->deadline <= now) {
+            microkit_channel ch = timeout_heap_min(&timeouts)->ch;
+            timeout_heap_cancel(&timeouts, ch);
+            microkit_notify(ch);
+        }
+
+        if (timeout_heap_empty(&timeouts)) {
+            gpt[IR] &= ~IR_OF1IE;
+            return;
+        }
+
+        uint64_t target = timeout_heap_min(&timeouts)->deadline + TIMEOUT_SLACK;
+        if ((target >> 32) != (now >> 32)) {
+            gpt[IR] &= ~IR_OF1IE;
+            return;
+        }
+
+        gpt[OCR1] = (uint32_t)target;
+        gpt[IR] |= IR_OF1IE;
+        if (get_ticks() < target) {
+            return;
+        }
+    }
+}
+
 void
 init(void)
 {
@@ -75,9 +148,9 @@ init(void)
     );
     gpt[CR] = cr;
 
-    gpt[IR] = (
-        (1 << 5) // rollover interrupt
-    );
+    gpt[IR] = IR_ROVIE;
+
+    timeout_heap_init(&timeouts);
 
     microkit_dbg_puts("CR: ");
     puthex32(gpt[0]);
@@ -97,47 +170,18 @@ notified(microkit_channel ch)
             gpt[SR] = sr;
             microkit_irq_ack(ch);
 
-            if (sr & (1 << 5)) {
+            if (sr & SR_ROV) {
                 overflow_count++;
-                /* FIXME: set the next timeout if required */
             }
-            if (sr & 1) {
-                gpt[IR] &= ~1;
-                timeout_active = false;
-                microkit_channel microkit_current_channel = active_channel;
-                timeouts[microkit_current_channel] = 0;
-                /* FIXME: set the next timeout if any are available */
 #if 0
             microkit_dbg_puts("GPT: irq sr=");
             puthex32(sr);
             microkit_dbg_puts(" cnt=");
-            puthex32(gpt[0x24 / 4]);
+            puthex32(gpt[CNT]);
             microkit_dbg_puts("\n");
 #endif
-                microkit_notify(microkit_current_channel);
-            }
-
-            if (pending_timeouts && !timeout_active) {
-                /* find next timeout */
-                uint64_t next_timeout = UINT64_MAX;
-                microkit_channel ch = -1;
-                for (unsigned i = 0; i < MICROKIT_MAX_CHANNELS; i++) {
-                    if (timeouts[i] != 0 && timeouts[i] < next_timeout) {
-                        next_timeout = timeouts[i];
-                        ch = i;
-                    }
-                }
-                /* FIXME: Is there a race here?  -- Probably! Fix it later. */
-                if (ch != -1 && overflow_count == (next_timeout >> 32)) {
-                    pending_timeouts--;
-                    gpt[OCR1] = next_timeout;
-                    gpt[IR] |= 1;
-                    timeout_active = true;
-                    current_timeout = next_timeout;
-                    active_channel = ch;
-                }
-            }
-
+            /* Both a compare match and a rollover may make a new deadline reachable */
+            expire_and_rearm();
             break;
         }
         default:
@@ -146,20 +190,6 @@ notified(microkit_channel ch)
     }
 }
 
-static uint64_t get_ticks(void) {
-    /* FIXME: If an overflow interrupt happens in the middle here we are in trouble */
-    uint64_t overflow = overflow_count;
-    uint32_t sr1 = gpt[SR];
-    uint32_t cnt = gpt[CNT];
-    uint32_t sr2 = gpt[SR];
-    if ((sr2 & (1 << 5)) && (!(sr1 & (1 << 5)))) {
-        /* rolled-over during - 64-bit time must be the overflow */
-        cnt = gpt[CNT];
-        overflow++;
-    }
-    return (overflow << 32) | cnt;
-}
-
 seL4_MessageInfo_t
 protected(microkit_channel ch, microkit_msginfo msginfo)
 {
@@ -169,33 +199,22 @@ protected(microkit_channel ch, microkit_msginfo msginfo)
             seL4_SetMR(0, get_ticks());
             return microkit_msginfo_new(0, 1);
         case 1: {
-            /* FIXME: There is a race here, if there are higher priority
-             * protection domains it is possible arbitrary amount of time
-             * could elapse between any of these instructions. The code
-             * should be made robust against such a possibility.
+            /*
+             * The deadline is absolute from here on, so however long a
+             * higher priority PD delays the rest of this call the timeout
+             * still expires relative to when it was requested.
              */
             uint64_t rel_timeout = seL4_GetMR(0);
-            uint64_t cur_ticks = get_ticks();
-            uint64_t abs_timeout = cur_ticks + rel_timeout;
-            timeouts[ch] = abs_timeout;
-            if ((!timeout_active || abs_timeout < current_timeout) && (cur_ticks >> 32 == abs_timeout >> 32)) {
-                if (timeout_active) {
-                    /* there current timeout is now treated as pending */
-                    pending_timeouts++;
-                }
-                gpt[OCR1] = abs_timeout;
-                gpt[IR] |= 1;
-                timeout_active = true;
-                current_timeout = abs_timeout;
-                active_channel = ch;
-            } else {
-                pending_timeouts++;
+            uint64_t abs_timeout = get_ticks() + rel_timeout;
+            timeout_heap_update(&timeouts, ch, abs_timeout);
+            if (timeout_heap_min(&timeouts)->ch == ch) {
+                expire_and_rearm();
             }
 #if 0
             microkit_dbg_puts("GPT: set timeout ch = ");
             puthex32(ch);
             microkit_dbg_puts(" - " );
-            puthex32(timeout);
+            puthex32(abs_timeout);
             microkit_dbg_puts("\n");
 #endif
             return microkit_msginfo_new(0, 1);
@@ -5,6 +5,9 @@
  */
 #include <stdint.h>
 #include <microkit.h>
+#include "dbg.h"
+#include "memops.h"
+#include "pkt_ring.h"
 
 #define GPT_CH 0
 #define OUTER_INPUT_CH 1
@@ -20,28 +23,70 @@
 #define INNER_INPUT inner_input_vaddr
 #define INNER_OUTPUT inner_output_vaddr
 
+#define OUTER_INPUT_RING ((volatile struct pkt_ring *)outer_input_ring_vaddr)
+#define OUTER_OUTPUT_RING ((volatile struct pkt_ring *)outer_output_ring_vaddr)
+#define INNER_INPUT_RING ((volatile struct pkt_ring *)inner_input_ring_vaddr)
+#define INNER_OUTPUT_RING ((volatile struct pkt_ring *)inner_output_ring_vaddr)
+
 
 #define BUFFER_MAX 1024
 
-unsigned outer_input_index = 0;
-unsigned inner_input_index = 0;
+/* Free-running indices this PD owns: head of each input ring, tail of each output ring */
+static uint32_t outer_input_head = 0;
+static uint32_t inner_input_head = 0;
 
-unsigned outer_output_index = 0;
-unsigned inner_output_index = 0;
+static uint32_t outer_output_tail = 0;
+static uint32_t inner_output_tail = 0;
 
 uintptr_t outer_input_vaddr;
 uintptr_t outer_output_vaddr;
 uintptr_t inner_input_vaddr;
 uintptr_t inner_output_vaddr;
 
+uintptr_t outer_input_ring_vaddr;
+uintptr_t outer_output_ring_vaddr;
+uintptr_t inner_input_ring_vaddr;
+uintptr_t inner_output_ring_vaddr;
+
 struct buffer_descriptor {
     uint16_t data_length;
-    uint16_t flags;
 };
 
+/*
+ * Packets per notification is the batching factor; reported on every GPT
+ * tick, or with no GPT (PASS_NO_GPT) every PASS_REPORT_BATCHES batches
+ */
+static uint64_t forwarded_packets = 0;
+static uint64_t forwarded_batches = 0;
+
+#ifndef PASS_REPORT_BATCHES
+#define PASS_REPORT_BATCHES 1024
+#endif
+
 
 volatile uint64_t *shared_counter = (uint64_t *)(uintptr_t)0x1800000;
 
+static void
+report_forwarded(void)
+{
+    microkit_dbg_puts("PASS|METRIC:");
+    dbg_put_kv("packets", forwarded_packets);
+    dbg_put_kv("batches", forwarded_batches);
+    microkit_dbg_puts("\n");
+}
+
+static void
+count_batch(uint32_t packets)
+{
+    forwarded_packets += packets;
+    forwarded_batches++;
+#ifdef PASS_NO_GPT
+    if (forwarded_batches % PASS_REPORT_BATCHES == 0) {
+        report_forwarded();
+    }
+#endif
+}
+
 static char
 hexchar(unsigned int v)
 {
@@ -107,30 +152,6 @@ puthex64(uint64_t x)
     microkit_dbg_puts(buffer);
 }
 
-static void
-mycpy(volatile void *dst, volatile void *src, unsigned int length)
-{
-    volatile uint64_t *d = dst;
-    volatile uint64_t *s = src;
-    int i = 0;
-    int l = length / 64;
-    if (length % 64) {
-        l++;
-    }
-    while (l) {
-        d[i] = s[i];
-        d[i + 1] = s[i + 1];
-        d[i + 2] = s[i + 2];
-        d[i + 3] = s[i + 3];
-        d[i + 4] = s[i + 4];
-        d[i + 5] = s[i + 5];
-        d[i + 6] = s[i + 6];
-        d[i + 7] = s[i + 7];
-        l--;
-        i += 8;
-    }
-}
-
 
 static void
 dump_hex(const uint8_t *d, unsigned int length)
@@ -173,18 +194,106 @@ gpt_timer(uint64_t timeout)
     (void) microkit_ppcall(GPT_CHANNEL, microkit_msginfo_new(1, 1));
 }
 
+#ifdef PASS_ZERO_COPY
+
+/*
+ * ethernet_zero_copy.system maps each eth PD's output data region as its
+ * peer's input region, so a packet never moves: forwarding publishes the
+ * producer's tail on the consumer's ring, and the slots go back to the
+ * producer once the consumer releases them. Slot n of one ring is slot n
+ * of the other, so the two rings advance in lockstep.
+ */
+static void
+forward(volatile struct pkt_ring *in, uintptr_t in_buf, uint32_t *in_head,
+        volatile struct pkt_ring *out, uintptr_t out_buf, uint32_t *out_tail,
+        microkit_channel out_ch)
+{
+    uint32_t tail = pkt_ring_tail(in);
+
+    *in_head = pkt_ring_head(out);
+    pkt_ring_release(in, *in_head);
+
+    if (tail != *out_tail) {
+        count_batch(tail - *out_tail);
+        *out_tail = tail;
+        pkt_ring_publish(out, tail);
+        microkit_notify(out_ch);
+    }
+}
+
+/* The consumer finished a batch: the producer may reuse those slots */
+static void
+reclaim(volatile struct pkt_ring *in, uint32_t *in_head, volatile struct pkt_ring *out)
+{
+    *in_head = pkt_ring_head(out);
+    pkt_ring_release(in, *in_head);
+}
+
+#else
+
+/* Copy everything the producer has published, then publish and notify once */
+static void
+forward(volatile struct pkt_ring *in, uintptr_t in_buf, uint32_t *in_head,
+        volatile struct pkt_ring *out, uintptr_t out_buf, uint32_t *out_tail,
+        microkit_channel out_ch)
+{
+    uint32_t head = *in_head;
+    uint32_t tail = pkt_ring_tail(in);
+    uint32_t otail = *out_tail;
+    uint32_t ohead = pkt_ring_head(out);
+
+    for (; head != tail; head++) {
+        volatile struct buffer_descriptor *bd = (void *)(in_buf + (BUFFER_SIZE * (head % BUFFER_MAX)));
+        volatile void *pkt = (void *)(in_buf + (BUFFER_SIZE * (head % BUFFER_MAX)) + DATA_OFFSET);
+
+        if (otail - ohead == BUFFER_MAX) {
+            ohead = pkt_ring_head(out);
+            if (otail - ohead == BUFFER_MAX) {
+                microkit_dbg_puts("PASS: can't pass buffer (no space in output ring)\n");
+                continue;
+            }
+        }
+
+        volatile struct buffer_descriptor *obd = (void *)(out_buf + (BUFFER_SIZE * (otail % BUFFER_MAX)));
+        volatile void *opkt = (void *)(out_buf + (BUFFER_SIZE * (otail % BUFFER_MAX)) + DATA_OFFSET);
+        obd->data_length = bd->data_length;
+        memcpy((void *)opkt, (void *)pkt, bd->data_length);
+        otail++;
+    }
+
+    *in_head = head;
+    pkt_ring_release(in, head);
+
+    if (otail != *out_tail) {
+        count_batch(otail - *out_tail);
+        *out_tail = otail;
+        pkt_ring_publish(out, otail);
+        microkit_notify(out_ch);
+    }
+}
+
+#endif
 
 void
 init(void)
 {
     microkit_dbg_puts("pass protection domain init function running\n");
 
+#ifndef PASS_NO_GPT
     /* Example calling a PP */
     microkit_dbg_puts("ticks: ");
     puthex32(gpt_ticks());
     microkit_dbg_puts("\n");
 
     gpt_timer(0x1000000);
+#endif
+
+#ifdef PASS_ZERO_COPY
+    /* The eth PDs' output slots are only freed when their peer says so */
+    OUTER_OUTPUT_RING->notify_on_release = 1;
+    INNER_OUTPUT_RING->notify_on_release = 1;
+    microkit_dbg_puts("pass: zero-copy forwarding\n");
+#endif
 }
 
 void
@@ -195,85 +304,33 @@ notified(microkit_channel ch)
             microkit_dbg_puts("tick! ticks=");
             puthex64(gpt_ticks());
             microkit_dbg_puts("\n");
+            report_forwarded();
             gpt_timer(0x1000000);
 
         case OUTER_INPUT_CH:
-
-            for (;;) {
-                volatile struct buffer_descriptor *bd = (void *)(uintptr_t)(OUTER_INPUT + (BUFFER_SIZE * outer_input_index));
-                volatile void *pkt = (void *)(uintptr_t)(OUTER_INPUT + (BUFFER_SIZE * outer_input_index) + DATA_OFFSET);
-                if (bd->flags == 0) {
-                    break;
-                }
-
-                outer_input_index++;
-                if (outer_input_index == BUFFER_MAX) {
-                    outer_input_index = 0;
-                }
-
-                volatile struct buffer_descriptor *obd = (void *)(uintptr_t)(INNER_OUTPUT + (BUFFER_SIZE * inner_output_index));
-                volatile void *opkt = (void *)(uintptr_t)(INNER_OUTPUT + (BUFFER_SIZE * inner_output_index) + DATA_OFFSET);
-                if (obd->flags == 1) {
-                    microkit_dbg_puts("PASS: outer can't pass buffer (no space for inner)\n");
-                } else {
-                    obd->data_length = bd->data_length;
-
-                    mycpy(opkt, pkt, bd->data_length);
-                    obd->flags = 1;
-
-                    microkit_notify(INNER_OUTPUT_CH);
-
-                    inner_output_index++;
-                    if (inner_output_index == BUFFER_MAX) {
-                        inner_output_index = 0;
-                    }
-                }
-                bd->flags = 0;
-            }
-
+            forward(OUTER_INPUT_RING, OUTER_INPUT, &outer_input_head,
+                    INNER_OUTPUT_RING, INNER_OUTPUT, &inner_output_tail, INNER_OUTPUT_CH);
             break;
 
         case OUTER_OUTPUT_CH:
+#ifdef PASS_ZERO_COPY
+            reclaim(INNER_INPUT_RING, &inner_input_head, OUTER_OUTPUT_RING);
+#else
             microkit_dbg_puts("outer output\n");
+#endif
             break;
 
         case INNER_INPUT_CH:
-            for (;;) {
-                volatile struct buffer_descriptor *bd = (void *)(uintptr_t)(INNER_INPUT + (BUFFER_SIZE * inner_input_index));
-                volatile void *pkt = (void *)(uintptr_t)(INNER_INPUT + (BUFFER_SIZE * inner_input_index) + DATA_OFFSET);
-                if (bd->flags == 0) {
-                    break;
-                }
-
-                inner_input_index++;
-                if (inner_input_index == BUFFER_MAX) {
-                    inner_input_index = 0;
-                }
-
-                volatile struct buffer_descriptor *obd = (void *)(uintptr_t)(OUTER_OUTPUT + (BUFFER_SIZE * outer_output_index));
-                volatile void *opkt = (void *)(uintptr_t)(OUTER_OUTPUT + (BUFFER_SIZE * outer_output_index) + DATA_OFFSET);
-                if (obd->flags == 1) {
-                    microkit_dbg_puts("PASS: inner can't pass buffer (no space for outer)\n");
-                } else {
-                    obd->data_length = bd->data_length;
-                    mycpy(opkt, pkt, bd->data_length);
-                    obd->flags = 1;
-
-                    microkit_notify(OUTER_OUTPUT_CH);
-
-                    outer_output_index++;
-                    if (outer_output_index == BUFFER_MAX) {
-                        outer_output_index = 0;
-                    }
-                }
-
-                bd->flags = 0;
-
-            }
+            forward(INNER_INPUT_RING, INNER_INPUT, &inner_input_head,
+                    OUTER_OUTPUT_RING, OUTER_OUTPUT, &outer_output_tail, OUTER_OUTPUT_CH);
             break;
 
         case INNER_OUTPUT_CH:
+#ifdef PASS_ZERO_COPY
+            reclaim(OUTER_INPUT_RING, &outer_input_head, INNER_OUTPUT_RING);
+#else
             microkit_dbg_puts("inner output\n");
+#endif
             break;
 
         default:
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit CPU Isolation Demo - Client
+ *
+ * Released by the monitor once per tick: makes one protected call to the
+ * server, logs it through the logger, and records the time from its
+ * release to the server's reply. That includes any time it spent unable
+ * to run. When it is served a release from a new phase, or the monitor
+ * has finished, it reports the latencies of the phase before.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+#include "stats.h"
+#include "isolation.h"
+
+#define MONITOR_CH 0
+#define SERVER_CH 1
+#define LOGGER_CH 2
+
+#define MAX_SAMPLES 4096
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct isolation_control *)control_vaddr)
+
+static enum isolation_phase phase;
+static unsigned count;
+static uint64_t dropped;
+static uint64_t samples[MAX_SAMPLES];
+
+static void report(void)
+{
+    struct stats_summary s = stats_summarize_u64(samples, count);
+
+    microkit_dbg_puts("ISOLATION|METRIC: phase=");
+    microkit_dbg_puts(phase_names[phase]);
+    microkit_dbg_puts(" kind=latency");
+    dbg_put_kv("samples", count);
+    dbg_put_kv("dropped", dropped);
+    if (count > 0) {
+        dbg_put_kv("min_ns", timing_ticks_to_ns(s.min));
+        dbg_put_kv("p50_ns", timing_ticks_to_ns(s.p50));
+        dbg_put_kv("p99_ns", timing_ticks_to_ns(s.p99));
+        dbg_put_kv("max_ns", timing_ticks_to_ns(s.max));
+        dbg_put_kv("avg_ns", timing_ticks_to_ns(s.avg));
+    }
+    microkit_dbg_puts("\n");
+
+    count = 0;
+    dropped = 0;
+}
+
+static void serve(void)
+{
+    enum isolation_phase released_in = CONTROL->release_phase;
+
+    seL4_SetMR(0, CONTROL->client_calls);
+    (void) microkit_ppcall(SERVER_CH, microkit_msginfo_new(0, 1));
+    uint64_t latency = timing_now() - CONTROL->release_time;
+
+    CONTROL->client_calls++;
+    CONTROL->client_pending = 0;
+    microkit_notify(LOGGER_CH);
+
+    if (released_in != phase) {
+        report();
+        phase = released_in;
+    }
+    if (count < MAX_SAMPLES) {
+        samples[count++] = latency;
+    } else {
+        dropped++;
+    }
+}
+
+void init(void)
+{
+    phase = PHASE_BASELINE;
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != MONITOR_CH) {
+        microkit_dbg_puts("ISOLATION|ERROR: client notified on unexpected channel\n");
+        return;
+    }
+
+    if (CONTROL->client_pending) {
+        serve();
+    }
+    if (CONTROL->phase == NUM_PHASES) {
+        report();
+        microkit_dbg_puts("ISOLATION|INFO: done\n");
+    }
+}
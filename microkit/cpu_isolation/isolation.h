@@ -0,0 +1,44 @@
+/*
+ * Copyright 2025
+ * Control page shared by the CPU isolation demo PDs
+ *
+ * The monitor releases the client once per tick and tracks how far the
+ * client and the logger get; the client and logger count their progress
+ * here.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include "timing.h"
+
+enum isolation_phase {
+    /* No runaway */
+    PHASE_BASELINE,
+    /* Runaway spinner limited by an MCS budget */
+    PHASE_RUNAWAY_BUDGET,
+    /* Runaway spinner with the whole CPU */
+    PHASE_RUNAWAY_NO_BUDGET,
+    NUM_PHASES,
+};
+
+static const char *const phase_names[] = {
+    "baseline", "runaway_budget", "runaway_no_budget",
+};
+
+struct isolation_control {
+    /* Current phase; NUM_PHASES once the demo is over. Written by the monitor */
+    uint32_t phase;
+    /*
+     * Set by the monitor with release_time and release_phase when it
+     * releases the client, cleared by the client once it has been
+     * served. A tick that finds it still set is a missed release.
+     */
+    uint32_t client_pending;
+    uint32_t release_phase;
+    uint64_t release_time;
+    /* Progress counters */
+    uint64_t client_calls;
+    uint64_t logger_entries;
+};
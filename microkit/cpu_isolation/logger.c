@@ -0,0 +1,29 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit CPU Isolation Demo - Logger
+ *
+ * Lowest-priority PD: counts the client's log notifications, so the
+ * monitor can see whether background work still gets any CPU. Entries
+ * the client sends while the logger cannot run coalesce into one.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "isolation.h"
+
+#define CLIENT_CH 0
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct isolation_control *)control_vaddr)
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch == CLIENT_CH) {
+        CONTROL->logger_entries++;
+    }
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit CPU Isolation Demo - Monitor
+ *
+ * Highest-priority PD and parent of both runaway spinners. Every TICK_US
+ * it releases the client, which makes one protected call to the server
+ * and logs it through the logger. Each phase lasts PHASE_MS:
+ *
+ *   baseline           no spinner
+ *   runaway_budget     a spinner above the client and logger, limited by
+ *                      its MCS budget
+ *   runaway_no_budget  the same spinner with no budget of its own to run
+ *                      out of
+ *
+ * At the end of a phase the spinner is stopped and the monitor reports
+ * the releases the client missed and, for the client and the logger, how
+ * much they got done and their longest stretch without progress. The
+ * client reports its release-to-reply latency itself.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+#include "isolation.h"
+
+#define IRQ_CH 0
+#define SPIN_BUDGET_CH 1
+#define SPIN_NO_BUDGET_CH 2
+#define CLIENT_CH 3
+
+#define SPIN_BUDGET_ID 1
+#define SPIN_NO_BUDGET_ID 2
+
+#define CNTP_CTL_ENABLE (1 << 0)
+
+#ifndef PHASE_MS
+#define PHASE_MS 2000
+#endif
+
+#ifndef TICK_US
+#define TICK_US 1000
+#endif
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct isolation_control *)control_vaddr)
+
+static const microkit_channel spin_channels[] = { 0, SPIN_BUDGET_CH, SPIN_NO_BUDGET_CH };
+static const microkit_child spin_ids[] = { 0, SPIN_BUDGET_ID, SPIN_NO_BUDGET_ID };
+
+/* Progress of one PD, sampled every tick */
+struct progress {
+    uint64_t start;
+    uint64_t last;
+    uint64_t last_change;
+    uint64_t max_stall;
+};
+
+static uint64_t freq;
+static uint64_t tick_ticks;
+static uint64_t next_tick;
+static uint64_t phase_end;
+
+static uint64_t releases;
+static uint64_t missed;
+static struct progress client;
+static struct progress logger;
+
+static inline void arm_timer(uint64_t cval)
+{
+    __asm__ volatile("msr cntp_cval_el0, %0" : : "r" (cval));
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" ((uint64_t)CNTP_CTL_ENABLE));
+}
+
+static inline void disarm_timer(void)
+{
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" ((uint64_t)0));
+}
+
+static void progress_start(struct progress *p, uint64_t count, uint64_t now)
+{
+    p->start = p->last = count;
+    p->last_change = now;
+    p->max_stall = 0;
+}
+
+static void progress_sample(struct progress *p, uint64_t count, uint64_t now)
+{
+    if (count != p->last) {
+        p->last = count;
+        p->last_change = now;
+    } else if (now - p->last_change > p->max_stall) {
+        p->max_stall = now - p->last_change;
+    }
+}
+
+static void start_phase(uint64_t now)
+{
+    enum isolation_phase phase = CONTROL->phase;
+
+    releases = missed = 0;
+    progress_start(&client, CONTROL->client_calls, now);
+    progress_start(&logger, CONTROL->logger_entries, now);
+    phase_end = now + PHASE_MS * freq / 1000;
+
+    microkit_dbg_puts("ISOLATION|INFO: phase ");
+    microkit_dbg_puts(phase_names[phase]);
+    microkit_dbg_puts("\n");
+
+    if (phase != PHASE_BASELINE) {
+        microkit_notify(spin_channels[phase]);
+    }
+}
+
+static void report(enum isolation_phase phase)
+{
+    microkit_dbg_puts("ISOLATION|METRIC: phase=");
+    microkit_dbg_puts(phase_names[phase]);
+    microkit_dbg_puts(" kind=progress");
+    dbg_put_kv("releases", releases);
+    dbg_put_kv("missed", missed);
+    dbg_put_kv("client_calls", client.last - client.start);
+    dbg_put_kv("client_max_stall_us", timing_ticks_to_us(client.max_stall));
+    dbg_put_kv("logger_entries", logger.last - logger.start);
+    dbg_put_kv("logger_max_stall_us", timing_ticks_to_us(logger.max_stall));
+    microkit_dbg_puts("\n");
+}
+
+/* Returns 0 once every phase has run */
+static int end_phase(uint64_t now)
+{
+    enum isolation_phase phase = CONTROL->phase;
+
+    if (phase != PHASE_BASELINE) {
+        microkit_pd_stop(spin_ids[phase]);
+    }
+    report(phase);
+
+    CONTROL->phase = phase + 1;
+    if (phase + 1 == NUM_PHASES) {
+        return 0;
+    }
+    start_phase(now);
+    return 1;
+}
+
+static void release_client(uint64_t now)
+{
+    releases++;
+    if (CONTROL->client_pending) {
+        missed++;
+        return;
+    }
+    CONTROL->release_time = now;
+    CONTROL->release_phase = CONTROL->phase;
+    CONTROL->client_pending = 1;
+    microkit_notify(CLIENT_CH);
+}
+
+static void handle_tick(void)
+{
+    uint64_t now = timing_now();
+
+    disarm_timer();
+
+    progress_sample(&client, CONTROL->client_calls, now);
+    progress_sample(&logger, CONTROL->logger_entries, now);
+
+    if (now >= phase_end && !end_phase(now)) {
+        /* Let the client serve anything outstanding and report */
+        microkit_notify(CLIENT_CH);
+        microkit_dbg_puts("ISOLATION|INFO: all phases done\n");
+        return;
+    }
+
+    release_client(now);
+
+    /* Skip ticks that were missed altogether rather than firing a burst */
+    do {
+        next_tick += tick_ticks;
+    } while (next_tick <= now);
+    arm_timer(next_tick);
+}
+
+void init(void)
+{
+    freq = timing_freq();
+    tick_ticks = TICK_US * freq / 1000000;
+
+    microkit_dbg_puts("ISOLATION|INFO: starting");
+    dbg_put_kv("phase_ms", PHASE_MS);
+    dbg_put_kv("tick_us", TICK_US);
+    microkit_dbg_puts("\n");
+
+    disarm_timer();
+    uint64_t now = timing_now();
+    CONTROL->phase = PHASE_BASELINE;
+    start_phase(now);
+    next_tick = now + tick_ticks;
+    arm_timer(next_tick);
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch == IRQ_CH) {
+        /* Level triggered: the comparator is disabled or moved before the ack */
+        handle_tick();
+        microkit_irq_ack(ch);
+    } else {
+        microkit_dbg_puts("ISOLATION|ERROR: notification on unexpected channel\n");
+    }
+}
+
+seL4_Bool fault(microkit_child child, microkit_msginfo msginfo, microkit_msginfo *reply_msginfo)
+{
+    microkit_dbg_puts("ISOLATION|ERROR: spinner faulted, stopping it\n");
+    microkit_pd_stop(child);
+    return seL4_False;
+}
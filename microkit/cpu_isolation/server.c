@@ -0,0 +1,22 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit CPU Isolation Demo - Server
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+}
+
+seL4_MessageInfo_t protected(microkit_channel ch, microkit_msginfo msginfo)
+{
+    seL4_SetMR(0, seL4_GetMR(0) + 1);
+    return microkit_msginfo_new(0, 1);
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit CPU Isolation Demo - Runaway Spinner
+ *
+ * Spins forever from the monitor's notification until the monitor stops
+ * it. The same image runs with and without an MCS budget.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+
+#define MONITOR_CH 0
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != MONITOR_CH) {
+        return;
+    }
+    for (;;) {
+        __asm__ volatile("" ::: "memory");
+    }
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault-Injection Campaign
+ *
+ * Parent of the injector. Runs one phase of PHASE_MS per fault type (see
+ * campaign.h), starting with a baseline in which nothing is injected. In
+ * each phase the injector is told to misbehave at pseudo-random times,
+ * inject_hz[type] times a second on average (intervals uniform between
+ * half and one and a half of the mean). Each fault type's rate defaults
+ * to INJECT_HZ and can be set on its own, e.g. INJECT_HZ_RUNAWAY. Faults come back through fault() and
+ * the injector is restarted on a fresh stack; a runaway loop or IPC flood
+ * does not fault, so it is killed and restarted KILL_AFTER_US after it
+ * was started, the way a watchdog would.
+ *
+ * Times come from the EL1 physical timer (PPI 30). The client measures
+ * what all this does to its own protected calls and reports per phase.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "pd_snapshot.h"
+#include "campaign.h"
+
+#define IRQ_CH 0
+#define INJECTOR_CH 1
+
+#define INJECTOR_ID 1
+
+#define CNTP_CTL_ENABLE (1 << 0)
+
+#ifndef PHASE_MS
+#define PHASE_MS 2000
+#endif
+
+#ifndef INJECT_HZ
+#define INJECT_HZ 20
+#endif
+#ifndef INJECT_HZ_NULL_WRITE
+#define INJECT_HZ_NULL_WRITE INJECT_HZ
+#endif
+#ifndef INJECT_HZ_UNALIGNED
+#define INJECT_HZ_UNALIGNED INJECT_HZ
+#endif
+#ifndef INJECT_HZ_STACK_OVERFLOW
+#define INJECT_HZ_STACK_OVERFLOW INJECT_HZ
+#endif
+#ifndef INJECT_HZ_RUNAWAY
+#define INJECT_HZ_RUNAWAY INJECT_HZ
+#endif
+#ifndef INJECT_HZ_IPC_FLOOD
+#define INJECT_HZ_IPC_FLOOD INJECT_HZ
+#endif
+
+/* Mean injections per second in each phase; the baseline only wakes up to do nothing */
+static const uint64_t inject_hz[NUM_FAULT_TYPES] = {
+    [FAULT_NONE] = INJECT_HZ,
+    [FAULT_NULL_WRITE] = INJECT_HZ_NULL_WRITE,
+    [FAULT_UNALIGNED] = INJECT_HZ_UNALIGNED,
+    [FAULT_STACK_OVERFLOW] = INJECT_HZ_STACK_OVERFLOW,
+    [FAULT_RUNAWAY] = INJECT_HZ_RUNAWAY,
+    [FAULT_IPC_FLOOD] = INJECT_HZ_IPC_FLOOD,
+};
+
+#ifndef KILL_AFTER_US
+#define KILL_AFTER_US 5000
+#endif
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct campaign_control *)control_vaddr)
+
+static uint64_t freq;
+static uint64_t phase_end;
+static uint64_t next_inject;
+/* Deadline for killing a runaway or flood in progress, 0 if none */
+static uint64_t kill_at;
+/* Fault type of the latest injection; faults are counted against it */
+static enum fault_type injected;
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static inline void arm_timer(uint64_t cval)
+{
+    __asm__ volatile("msr cntp_cval_el0, %0" : : "r" (cval));
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" ((uint64_t)CNTP_CTL_ENABLE));
+}
+
+static inline void disarm_timer(void)
+{
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" ((uint64_t)0));
+}
+
+static uint64_t random_interval(void)
+{
+    uint64_t mean = freq / inject_hz[CONTROL->phase];
+
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return mean / 2 + (rng_state >> 33) % (mean + 1);
+}
+
+static void recycle_injector(void)
+{
+    /* Suspend first so a thread that is running or in a call gets restarted too */
+    microkit_pd_stop(INJECTOR_ID);
+    pd_snapshot_restart(INJECTOR_ID);
+}
+
+static void start_phase(uint64_t now)
+{
+    microkit_dbg_puts("CAMPAIGN|INFO: phase ");
+    microkit_dbg_puts(fault_names[CONTROL->phase]);
+    dbg_put_kv("inject_hz", inject_hz[CONTROL->phase]);
+    microkit_dbg_puts("\n");
+
+    phase_end = now + PHASE_MS * freq / 1000;
+    next_inject = now + random_interval();
+}
+
+static void inject(uint64_t now)
+{
+    enum fault_type type = CONTROL->phase;
+
+    next_inject = now + random_interval();
+    if (type == FAULT_NONE || kill_at != 0) {
+        return;
+    }
+
+    injected = type;
+    CONTROL->inject = type;
+    CONTROL->injections[type]++;
+    if (type == FAULT_RUNAWAY || type == FAULT_IPC_FLOOD) {
+        kill_at = now + KILL_AFTER_US * freq / 1000000;
+    }
+    microkit_notify(INJECTOR_CH);
+}
+
+static void kill(void)
+{
+    CONTROL->kills[injected]++;
+    recycle_injector();
+    kill_at = 0;
+}
+
+/* Returns 0 once the last phase has ended */
+static int end_phase(uint64_t now)
+{
+    if (kill_at != 0) {
+        kill();
+    }
+    CONTROL->phase++;
+    if (CONTROL->phase == NUM_FAULT_TYPES) {
+        return 0;
+    }
+    start_phase(now);
+    return 1;
+}
+
+static void handle_timer(void)
+{
+    uint64_t now = timing_now();
+
+    disarm_timer();
+
+    if (kill_at != 0 && now >= kill_at) {
+        kill();
+    }
+    if (now >= next_inject) {
+        inject(now);
+    }
+    if (now >= phase_end && !end_phase(now)) {
+        microkit_dbg_puts("CAMPAIGN|INFO: all phases done\n");
+        return;
+    }
+
+    uint64_t next = next_inject < phase_end ? next_inject : phase_end;
+    if (kill_at != 0 && kill_at < next) {
+        next = kill_at;
+    }
+    arm_timer(next);
+}
+
+void init(void)
+{
+    freq = timing_freq();
+
+    microkit_dbg_puts("CAMPAIGN|INFO: starting");
+    dbg_put_kv("phase_ms", PHASE_MS);
+    dbg_put_kv("inject_hz", INJECT_HZ);
+    dbg_put_kv("kill_after_us", KILL_AFTER_US);
+    microkit_dbg_puts("\n");
+
+    disarm_timer();
+    CONTROL->phase = FAULT_NONE;
+    start_phase(timing_now());
+    arm_timer(next_inject);
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch == IRQ_CH) {
+        /* Level triggered: the comparator is disabled or moved before the ack */
+        handle_timer();
+        microkit_irq_ack(ch);
+    } else {
+        microkit_dbg_puts("CAMPAIGN|ERROR: notification on unexpected channel\n");
+    }
+}
+
+seL4_Bool fault(microkit_child child, microkit_msginfo msginfo, microkit_msginfo *reply_msginfo)
+{
+    if (child != INJECTOR_ID) {
+        microkit_dbg_puts("CAMPAIGN|ERROR: fault from unexpected child, stopping it\n");
+        microkit_pd_stop(child);
+        return seL4_False;
+    }
+
+    CONTROL->faults[injected]++;
+    pd_snapshot_restart(child);
+
+    /* Restarted explicitly, so no reply */
+    return seL4_False;
+}
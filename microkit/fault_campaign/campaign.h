@@ -0,0 +1,49 @@
+/*
+ * Copyright 2025
+ * Control page shared by the fault-injection campaign PDs
+ *
+ * The campaign PD runs one phase per fault type and counts what it
+ * injected; the client reads the phase to know which fault its latency
+ * samples belong to, and the injector reads inject to know which fault to
+ * trigger.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include "timing.h"
+
+enum fault_type {
+    /* Baseline: the injector stays idle */
+    FAULT_NONE,
+    /* Store to address 0 */
+    FAULT_NULL_WRITE,
+    /* Exclusive load from an odd address, which faults whatever SCTLR.A says */
+    FAULT_UNALIGNED,
+    /* Recursion until the stack runs into the unmapped page below it */
+    FAULT_STACK_OVERFLOW,
+    /* Spins until the campaign kills it */
+    FAULT_RUNAWAY,
+    /* Back-to-back protected calls to the client's server until killed */
+    FAULT_IPC_FLOOD,
+    NUM_FAULT_TYPES,
+};
+
+static const char *const fault_names[] = {
+    "none", "null_write", "unaligned", "stack_overflow", "runaway", "ipc_flood",
+};
+
+struct campaign_control {
+    /* Current fault type; NUM_FAULT_TYPES once the campaign is over */
+    uint32_t phase;
+    /* Fault type the injector is notified to trigger */
+    uint32_t inject;
+    /* Per phase, written by the campaign PD */
+    uint64_t injections[NUM_FAULT_TYPES];
+    uint64_t faults[NUM_FAULT_TYPES];
+    uint64_t kills[NUM_FAULT_TYPES];
+};
+
+/* Value the server adds to the client's MR0, so the client can check replies */
+#define SERVER_REPLY_DELTA 1
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault-Injection Campaign - Client
+ *
+ * Issues protected calls to the server back to back for the whole
+ * campaign, from init(), at the lowest priority in the system. Every
+ * call is timed and checked, and when the campaign moves to the next
+ * fault type the client reports the phase that just ended:
+ *
+ *   calls/ok     a call is ok if the reply is correct and arrived within
+ *                CLIENT_DEADLINE_US; success_ppm is ok per million calls
+ *   late/bad     calls over the deadline, and calls with a wrong reply
+ *   latency      from a log-linear histogram with eight buckets per
+ *                power of two, so percentiles are within 12.5%
+ *
+ * along with the injections, faults and kills the campaign counted.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+#include "campaign.h"
+
+#define SERVER_CH 0
+
+#ifndef CLIENT_DEADLINE_US
+#define CLIENT_DEADLINE_US 1000
+#endif
+
+#define HIST_SUB_BITS 3
+#define HIST_SUB (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB)
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct campaign_control *)control_vaddr)
+
+static uint64_t freq;
+static uint64_t deadline_ticks;
+
+/* The phase being measured; latencies are in counter ticks */
+static uint64_t calls;
+static uint64_t ok;
+static uint64_t late;
+static uint64_t bad;
+static uint64_t lat_min;
+static uint64_t lat_max;
+static uint64_t lat_sum;
+static uint32_t hist[HIST_BUCKETS];
+
+static unsigned bucket_of(uint64_t v)
+{
+    if (v < HIST_SUB) {
+        return v;
+    }
+    unsigned msb = 63 - __builtin_clzll(v);
+    return (msb - HIST_SUB_BITS + 1) * HIST_SUB + ((v >> (msb - HIST_SUB_BITS)) & (HIST_SUB - 1));
+}
+
+/* Smallest value in bucket b */
+static uint64_t bucket_low(unsigned b)
+{
+    if (b < HIST_SUB) {
+        return b;
+    }
+    unsigned msb = b / HIST_SUB - 1 + HIST_SUB_BITS;
+    return (uint64_t)(HIST_SUB + b % HIST_SUB) << (msb - HIST_SUB_BITS);
+}
+
+/* Upper bound of the bucket holding the given fraction (in ppm) of samples */
+static uint64_t percentile(uint64_t ppm)
+{
+    uint64_t rank = calls * ppm / 1000000;
+    uint64_t seen = 0;
+
+    for (unsigned b = 0; b < HIST_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen > rank) {
+            uint64_t high = b + 1 < HIST_BUCKETS ? bucket_low(b + 1) - 1 : UINT64_MAX;
+            return high < lat_max ? high : lat_max;
+        }
+    }
+    return lat_max;
+}
+
+static void reset(void)
+{
+    calls = ok = late = bad = lat_max = lat_sum = 0;
+    lat_min = UINT64_MAX;
+    for (unsigned b = 0; b < HIST_BUCKETS; b++) {
+        hist[b] = 0;
+    }
+}
+
+static void record(uint64_t ticks, int correct)
+{
+    calls++;
+    if (!correct) {
+        bad++;
+    } else if (ticks > deadline_ticks) {
+        late++;
+    } else {
+        ok++;
+    }
+
+    lat_sum += ticks;
+    if (ticks < lat_min) {
+        lat_min = ticks;
+    }
+    if (ticks > lat_max) {
+        lat_max = ticks;
+    }
+    hist[bucket_of(ticks)]++;
+}
+
+static void report(enum fault_type type)
+{
+    microkit_dbg_puts("CAMPAIGN|METRIC: fault=");
+    microkit_dbg_puts(fault_names[type]);
+    dbg_put_kv("injections", CONTROL->injections[type]);
+    dbg_put_kv("faults", CONTROL->faults[type]);
+    dbg_put_kv("kills", CONTROL->kills[type]);
+    dbg_put_kv("calls", calls);
+    dbg_put_kv("ok", ok);
+    dbg_put_kv("late", late);
+    dbg_put_kv("bad", bad);
+    if (calls > 0) {
+        dbg_put_kv("success_ppm", ok * 1000000 / calls);
+        dbg_put_kv("min_ns", timing_ticks_to_ns(lat_min));
+        dbg_put_kv("p50_ns", timing_ticks_to_ns(percentile(500000)));
+        dbg_put_kv("p99_ns", timing_ticks_to_ns(percentile(990000)));
+        dbg_put_kv("p999_ns", timing_ticks_to_ns(percentile(999000)));
+        dbg_put_kv("max_ns", timing_ticks_to_ns(lat_max));
+        dbg_put_kv("avg_ns", timing_ticks_to_ns(lat_sum / calls));
+    }
+    microkit_dbg_puts("\n");
+}
+
+void init(void)
+{
+    uint64_t seq = 0;
+    uint32_t phase = CONTROL->phase;
+
+    freq = timing_freq();
+    deadline_ticks = CLIENT_DEADLINE_US * freq / 1000000;
+    reset();
+
+    microkit_dbg_puts("CAMPAIGN|INFO: client calling server");
+    dbg_put_kv("deadline_us", CLIENT_DEADLINE_US);
+    microkit_dbg_puts("\n");
+
+    while (phase < NUM_FAULT_TYPES) {
+        seL4_SetMR(0, seq);
+        uint64_t start = timing_now();
+        microkit_msginfo reply = microkit_ppcall(SERVER_CH, microkit_msginfo_new(0, 1));
+        uint64_t end = timing_now();
+
+        record(end - start, microkit_msginfo_get_label(reply) == 0 && seL4_GetMR(0) == seq + SERVER_REPLY_DELTA);
+        seq++;
+
+        if (CONTROL->phase != phase) {
+            report(phase);
+            reset();
+            phase = CONTROL->phase;
+        }
+    }
+
+    microkit_dbg_puts("CAMPAIGN|INFO: done\n");
+}
+
+void notified(microkit_channel ch)
+{
+}
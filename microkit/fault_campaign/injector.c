@@ -0,0 +1,93 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault-Injection Campaign - Injector
+ *
+ * Child of the campaign PD. Each notification triggers the fault type
+ * the campaign has put in the control page. The faulting types end in
+ * fault() in the campaign, which restarts this PD; the runaway loop and
+ * the IPC flood run until the campaign kills it. Its MCS budget (see
+ * system.system) is what bounds the CPU those two take from the client.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "campaign.h"
+
+#define CAMPAIGN_CH 0
+#define SERVER_CH 1
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct campaign_control *)control_vaddr)
+
+static uint64_t word[2];
+
+static void null_write(void)
+{
+    volatile uint64_t *null_ptr = (volatile uint64_t *)0x0;
+    *null_ptr = 0xDEADBEEF;
+}
+
+static void unaligned_access(void)
+{
+    /* Exclusives must be aligned even where ordinary loads need not be */
+    uint64_t val;
+    __asm__ volatile("ldaxr %0, [%1]" : "=r" (val) : "r" ((uintptr_t)word + 1) : "memory");
+}
+
+static __attribute__((noinline)) uint64_t recurse(uint64_t depth)
+{
+    volatile uint8_t frame[256];
+
+    frame[0] = depth;
+    if (depth == UINT64_MAX) {
+        return frame[0];
+    }
+    return recurse(depth + 1) + frame[0];
+}
+
+static void runaway(void)
+{
+    for (;;) {
+        __asm__ volatile("" ::: "memory");
+    }
+}
+
+static void ipc_flood(void)
+{
+    for (;;) {
+        seL4_SetMR(0, 0);
+        (void) microkit_ppcall(SERVER_CH, microkit_msginfo_new(0, 1));
+    }
+}
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != CAMPAIGN_CH) {
+        return;
+    }
+
+    switch (CONTROL->inject) {
+        case FAULT_NULL_WRITE:
+            null_write();
+            break;
+        case FAULT_UNALIGNED:
+            unaligned_access();
+            break;
+        case FAULT_STACK_OVERFLOW:
+            (void) recurse(0);
+            break;
+        case FAULT_RUNAWAY:
+            runaway();
+            break;
+        case FAULT_IPC_FLOOD:
+            ipc_flood();
+            break;
+        default:
+            break;
+    }
+}
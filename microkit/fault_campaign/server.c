@@ -0,0 +1,26 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault-Injection Campaign - Server
+ *
+ * Answers the client's protected calls, and the injector's during an IPC
+ * flood, with MR0 + SERVER_REPLY_DELTA.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "campaign.h"
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+}
+
+seL4_MessageInfo_t protected(microkit_channel ch, microkit_msginfo msginfo)
+{
+    seL4_SetMR(0, seL4_GetMR(0) + SERVER_REPLY_DELTA);
+    return microkit_msginfo_new(0, 1);
+}
@@ -8,42 +8,51 @@
  */
 #include <stdint.h>
 #include <microkit.h>
+#include "log_ring.h"
 
 #define SERVER_CH 0
 #define LOGGER_CH 1
 
+/* This PD's id in the logger's heads page */
+#define CLIENT_LOG 0
+
+/* Own log ring, read by the logger, and the logger's heads page */
+uintptr_t log_ring_vaddr;
+uintptr_t log_heads_vaddr;
+
+static struct log_producer log_out = { .id = CLIENT_LOG, .ch = LOGGER_CH };
+
 void init(void)
 {
-    microkit_dbg_puts("CLIENT|INFO: Initializing client component\n");
-    microkit_dbg_puts("CLIENT|INFO: Client will continue operating even if crasher fails\n");
+    log_out.ring = (volatile struct log_ring *)log_ring_vaddr;
+    log_out.heads = (const volatile struct log_heads *)log_heads_vaddr;
+    log_text(&log_out, "Initializing client component");
+    log_text(&log_out, "Will continue operating if crasher fails");
     
     /* Wait a bit to let crasher crash first */
     for (volatile int i = 0; i < 2000000; i++);
     
     /* Send message to server after crasher has crashed */
     microkit_msginfo msg = microkit_msginfo_new(1, 0);
-    microkit_dbg_puts("CLIENT|INFO: Sending message to server (after crasher crash)\n");
+    log_text(&log_out, "Sending message to server after crash");
     microkit_msginfo reply = microkit_ppcall(SERVER_CH, msg);
     uint64_t reply_label = microkit_msginfo_get_label(reply);
-    microkit_dbg_puts("CLIENT|INFO: Received reply from server (label=");
-    microkit_dbg_putc('0' + (reply_label % 10));
-    microkit_dbg_puts(") - Server still functioning!\n");
-    
-    /* Notify logger */
-    microkit_dbg_puts("CLIENT|INFO: Notifying logger (after crasher crash)\n");
-    microkit_notify(LOGGER_CH);
-    
-    microkit_dbg_puts("CLIENT|INFO: Client continues operating normally\n");
-    microkit_dbg_puts("CLIENT|INFO: Fault containment demonstrated - other components unaffected\n");
+    log_value(&log_out, "Server still functioning, reply label", reply_label);
+    log_text(&log_out, "Client continues operating normally");
+    log_text(&log_out, "Fault containment demonstrated");
+
+    /* Everything above reaches the logger as one batch */
+    log_flush(&log_out);
 }
 
 void notified(microkit_channel ch)
 {
     if (ch == SERVER_CH) {
-        microkit_dbg_puts("CLIENT|INFO: Received notification from server\n");
+        log_text(&log_out, "Received notification from server");
     } else if (ch == LOGGER_CH) {
-        microkit_dbg_puts("CLIENT|INFO: Received notification from logger\n");
+        log_text(&log_out, "Received notification from logger");
     }
+    log_flush(&log_out);
 }
 
 
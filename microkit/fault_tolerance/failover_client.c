@@ -0,0 +1,124 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault Tolerance Demo - Failover Client
+ *
+ * Client of the standby build. Sends REPLICA_ADD requests back to back
+ * through failover_ppcall() and checks every reply against the total it
+ * expects. After FAILOVER_COUNT failovers it reports:
+ *
+ *   requests    requests sent
+ *   reissued    calls aborted by a failover and sent again
+ *   lost        requests whose reply was missing or wrong
+ *   duplicates  reissued requests the new server found already applied
+ *
+ * and the failover latency of each reissued request, split into:
+ *
+ *   fault_to_handler   server's faulting store to the supervisor's fault()
+ *   handler_to_resume  fault() entry to the client being resumed
+ *   resume_to_served   resume to the reply from the other server
+ *   total              the sum of the three
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "stats.h"
+#include "failover.h"
+#include "mttr.h"
+#include "replica.h"
+
+#define PRIMARY_CH 0
+#define STANDBY_CH 1
+
+#ifndef FAILOVER_COUNT
+#define FAILOVER_COUNT 20
+#endif
+
+uintptr_t state_vaddr;
+#define STATE ((volatile struct replica_state *)state_vaddr)
+
+uintptr_t status_vaddr;
+
+static uint64_t fault_to_handler[FAILOVER_COUNT];
+static uint64_t handler_to_resume[FAILOVER_COUNT];
+static uint64_t resume_to_served[FAILOVER_COUNT];
+static uint64_t total[FAILOVER_COUNT];
+
+static void report(const char *phase, uint64_t *v, unsigned n)
+{
+    if (n == 0) {
+        return;
+    }
+    struct stats_summary s = stats_summarize_u64(v, n);
+
+    microkit_dbg_puts("FAILOVER|METRIC: phase=");
+    microkit_dbg_puts(phase);
+    dbg_put_kv("failovers", n);
+    dbg_put_kv("min_ns", timing_ticks_to_ns(s.min));
+    dbg_put_kv("p50_ns", timing_ticks_to_ns(s.p50));
+    dbg_put_kv("p99_ns", timing_ticks_to_ns(s.p99));
+    dbg_put_kv("max_ns", timing_ticks_to_ns(s.max));
+    dbg_put_kv("avg_ns", timing_ticks_to_ns(s.avg));
+    microkit_dbg_puts("\n");
+}
+
+void init(void)
+{
+    struct failover_client client = {
+        .status = (volatile struct failover_status *)status_vaddr,
+        .ch = { PRIMARY_CH, STANDBY_CH },
+    };
+    uint64_t seq = 0;
+    uint64_t expected = 0;
+    uint64_t lost = 0;
+    unsigned measured = 0;
+
+    microkit_dbg_puts("FAILOVER|INFO: starting");
+    dbg_put_kv("failovers", FAILOVER_COUNT);
+    microkit_dbg_puts("\n");
+
+    while (client.status->failovers < FAILOVER_COUNT) {
+        uint64_t reissued = client.reissued;
+
+        seq++;
+        expected += seq;
+        seL4_SetMR(0, seq);
+        seL4_SetMR(1, seq);
+        microkit_msginfo reply = failover_ppcall(&client, microkit_msginfo_new(REPLICA_ADD, 2));
+
+        if (microkit_msginfo_get_label(reply) != REPLICA_OK || seL4_GetMR(0) != expected) {
+            lost++;
+            /* Resynchronise, so each loss is counted once rather than on every reply after it */
+            seq = STATE->last_seq;
+            expected = STATE->total;
+        }
+
+        if (client.reissued != reissued && measured < FAILOVER_COUNT) {
+            uint64_t served = timing_now();
+            volatile struct failover_status *s = client.status;
+            fault_to_handler[measured] = s->handler_time - s->fault_time;
+            handler_to_resume[measured] = s->resume_time - s->handler_time;
+            resume_to_served[measured] = served - s->resume_time;
+            total[measured] = served - s->fault_time;
+            measured++;
+        }
+    }
+
+    microkit_dbg_puts("FAILOVER|METRIC: requests=");
+    dbg_put_u64(seq);
+    dbg_put_kv("failovers", client.status->failovers);
+    dbg_put_kv("reissued", client.reissued);
+    dbg_put_kv("lost", lost);
+    dbg_put_kv("duplicates", STATE->duplicates);
+    microkit_dbg_puts("\n");
+    report("fault_to_handler", fault_to_handler, measured);
+    report("handler_to_resume", handler_to_resume, measured);
+    report("resume_to_served", resume_to_served, measured);
+    report("total", total, measured);
+    microkit_dbg_puts("FAILOVER|INFO: done\n");
+}
+
+void notified(microkit_channel ch)
+{
+}
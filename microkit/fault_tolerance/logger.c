@@ -3,54 +3,106 @@
  * seL4 Microkit Fault Tolerance Demo - Logger Component
  * 
  * This logger continues functioning even when crasher component fails.
- * It captures fault events and logs them.
+ * The client, the server and the crasher each write structured records
+ * into their own log ring (see log_ring.h) and notify once per batch; on
+ * each wakeup the logger prints every record in timestamp order. The
+ * crasher's last records are in its ring before it faults, so they are
+ * printed even though the crasher is gone by the time the logger runs.
+ *
+ * The logger can read the three rings and write the heads page, and
+ * nothing else of the other PDs.
  *
  * SPDX-License-Identifier: BSD-2-Clause
  */
 #include <stdint.h>
 #include <microkit.h>
+#include "dbg.h"
+#include "log_ring.h"
 
 #define CLIENT_CH 0
 #define SERVER_CH 1
 #define CRASHER_CH 2
 
-static int log_count = 0;
+/* Producer ids, i.e. indices into the heads page */
+#define CLIENT_LOG 0
+#define SERVER_LOG 1
+#define CRASHER_LOG 2
+#define NUM_LOGS 3
+
+uintptr_t client_log_vaddr;
+uintptr_t server_log_vaddr;
+uintptr_t crasher_log_vaddr;
+uintptr_t log_heads_vaddr;
+
+static struct log_source sources[NUM_LOGS];
+static uint64_t log_count;
+
+static void print_record(const struct log_source *src, const volatile struct log_record *r)
+{
+    log_count++;
+    microkit_dbg_puts("LOGGER|INFO: [LOG #");
+    dbg_put_u64(log_count);
+    microkit_dbg_puts(" t=");
+    dbg_put_u64(timing_ticks_to_ns(r->timestamp));
+    microkit_dbg_puts("ns ");
+    microkit_dbg_puts(src->name);
+    microkit_dbg_puts("] ");
+    for (unsigned i = 0; i < LOG_TEXT_LEN && r->text[i] != '\0'; i++) {
+        microkit_dbg_putc(r->text[i]);
+    }
+    if (r->flags & LOG_RECORD_VALUE) {
+        microkit_dbg_putc('=');
+        dbg_put_u64(r->value);
+    }
+    microkit_dbg_puts("\n");
+}
 
 void init(void)
 {
+    sources[CLIENT_LOG].ring = (const volatile struct log_ring *)client_log_vaddr;
+    sources[CLIENT_LOG].name = "client";
+    sources[SERVER_LOG].ring = (const volatile struct log_ring *)server_log_vaddr;
+    sources[SERVER_LOG].name = "server";
+    sources[CRASHER_LOG].ring = (const volatile struct log_ring *)crasher_log_vaddr;
+    sources[CRASHER_LOG].name = "crasher";
+
     microkit_dbg_puts("LOGGER|INFO: Initializing logger component\n");
     microkit_dbg_puts("LOGGER|INFO: Logger ready to capture fault events\n");
     microkit_dbg_puts("LOGGER|INFO: Logger will continue operating even if crasher fails\n");
-    log_count = 0;
 }
 
 void notified(microkit_channel ch)
 {
-    log_count++;
-    
-    if (ch == CLIENT_CH) {
-        microkit_dbg_puts("LOGGER|INFO: [LOG #");
-        microkit_dbg_putc('0' + log_count);
-        microkit_dbg_puts("] Received notification from client\n");
-    } else if (ch == SERVER_CH) {
-        microkit_dbg_puts("LOGGER|INFO: [LOG #");
-        microkit_dbg_putc('0' + log_count);
-        microkit_dbg_puts("] Received notification from server\n");
-    } else if (ch == CRASHER_CH) {
-        microkit_dbg_puts("LOGGER|INFO: [LOG #");
-        microkit_dbg_putc('0' + log_count);
-        microkit_dbg_puts("] Received notification from crasher (before crash)\n");
-    } else {
-        microkit_dbg_puts("LOGGER|WARN: [LOG #");
-        microkit_dbg_putc('0' + log_count);
-        microkit_dbg_puts("] Received notification on unexpected channel\n");
+    if (ch != CLIENT_CH && ch != SERVER_CH && ch != CRASHER_CH) {
+        microkit_dbg_puts("LOGGER|WARN: Received notification on unexpected channel\n");
+        return;
     }
-    
-    /* After crasher fails, logger should still receive notifications */
-    microkit_dbg_puts("LOGGER|INFO: Logger continues operating after crasher fault\n");
-    microkit_dbg_puts("LOGGER|INFO: Total logs captured: ");
-    microkit_dbg_putc('0' + log_count);
-    microkit_dbg_puts("\n");
-}
 
+    unsigned printed = log_drain(sources, NUM_LOGS, (volatile struct log_heads *)log_heads_vaddr, print_record);
 
+    for (unsigned i = 0; i < NUM_LOGS; i++) {
+        uint64_t dropped = sources[i].ring->dropped;
+        if (dropped != sources[i].dropped_seen) {
+            microkit_dbg_puts("LOGGER|WARN: ");
+            microkit_dbg_puts(sources[i].name);
+            microkit_dbg_puts(" dropped");
+            dbg_put_kv("records", dropped - sources[i].dropped_seen);
+            microkit_dbg_puts("\n");
+            sources[i].dropped_seen = dropped;
+        }
+        if (sources[i].skipped != 0) {
+            microkit_dbg_puts("LOGGER|WARN: ");
+            microkit_dbg_puts(sources[i].name);
+            microkit_dbg_puts(" ring index out of range, skipped");
+            dbg_put_kv("records", sources[i].skipped);
+            microkit_dbg_puts("\n");
+            sources[i].skipped = 0;
+        }
+    }
+
+    if (printed != 0) {
+        microkit_dbg_puts("LOGGER|INFO: Total logs captured: ");
+        dbg_put_u64(log_count);
+        microkit_dbg_puts("\n");
+    }
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault Tolerance Demo - Recovery Timing
+ *
+ * Page shared by the supervisor and its crasher child. The crasher stamps
+ * the moment it is about to fault and the moment its first request after
+ * a (re)start has been served; the supervisor stamps its own steps and
+ * turns the three into fault-to-handler, handler-to-restart and
+ * restart-to-served latencies. The crasher also reports what restoring
+ * its snapshot (see pd_snapshot.h) cost on each boot.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include "timing.h"
+
+struct mttr_shared {
+    /* Number of restarts so far; 0 on the first boot. Written by the supervisor */
+    uint64_t round;
+    /* Counter values written by the crasher */
+    uint64_t fault_time;
+    uint64_t served_time;
+    /* Snapshot restore on the latest boot: counter ticks and pages copied back */
+    uint64_t restore_ticks;
+    uint64_t restored_pages;
+    /* Boots that found state left over from before the restart */
+    uint64_t stale_boots;
+};
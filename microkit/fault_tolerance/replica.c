@@ -0,0 +1,72 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault Tolerance Demo - Server Replica
+ *
+ * Image of both the primary and the standby server in the standby build.
+ * All state lives in the shared region (see replica.h), so whichever
+ * replica the client calls carries on from the other's last request: the
+ * standby is warm without any copying.
+ *
+ * To exercise failover, the replica serving the FAIL_EVERY-th request
+ * since the latest failover faults while handling it: before applying it
+ * for an even sequence number, after applying it but before replying for
+ * an odd one. The second case is what the sequence-number check is for.
+ * The supervisor restarts a faulted replica, which becomes the standby.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "mttr.h"
+#include "replica.h"
+
+#ifndef FAIL_EVERY
+#define FAIL_EVERY 1000
+#endif
+
+uintptr_t state_vaddr;
+#define STATE ((volatile struct replica_state *)state_vaddr)
+
+static void crash(void)
+{
+    STATE->fault_time = timing_now();
+    *(volatile uint64_t *)0 = 0;
+}
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+}
+
+microkit_msginfo protected(microkit_channel ch, microkit_msginfo msginfo)
+{
+    if (microkit_msginfo_get_label(msginfo) != REPLICA_ADD || microkit_msginfo_get_count(msginfo) != 2) {
+        return microkit_msginfo_new(REPLICA_OUT_OF_ORDER, 0);
+    }
+
+    uint64_t seq = seL4_GetMR(0);
+    uint64_t value = seL4_GetMR(1);
+    int inject = ++STATE->served == FAIL_EVERY;
+
+    if (seq == STATE->last_seq) {
+        /* Applied before a failover, but the reply never made it */
+        STATE->duplicates++;
+    } else if (seq == STATE->last_seq + 1) {
+        if (inject && seq % 2 == 0) {
+            crash();
+        }
+        STATE->total += value;
+        STATE->last_seq = seq;
+        if (inject) {
+            crash();
+        }
+    } else {
+        return microkit_msginfo_new(REPLICA_OUT_OF_ORDER, 0);
+    }
+
+    seL4_SetMR(0, STATE->total);
+    return microkit_msginfo_new(REPLICA_OK, 1);
+}
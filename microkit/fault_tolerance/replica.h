@@ -0,0 +1,35 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault Tolerance Demo - Replicated Server State
+ *
+ * State region shared by the primary and the standby server, which run
+ * the same image (replica.c), and by the supervisor. The service keeps a
+ * running total: each request adds a value to it and gets the new total
+ * back. Requests carry a sequence number so that one reissued after a
+ * failover is not applied twice (see failover.h).
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+
+enum replica_label {
+    /* MR0: sequence number, MR1: value -> MR0: new total */
+    REPLICA_ADD = 1,
+    /* Replies */
+    REPLICA_OK = 2,
+    REPLICA_OUT_OF_ORDER = 3,
+};
+
+struct replica_state {
+    /* Sequence number of the latest request applied, and the total after it */
+    uint64_t last_seq;
+    uint64_t total;
+    /* Requests served since the latest failover; reset by the supervisor */
+    uint64_t served;
+    /* Reissued requests that had been applied before the failover */
+    uint64_t duplicates;
+    /* Counter value just before the latest injected fault */
+    uint64_t fault_time;
+};
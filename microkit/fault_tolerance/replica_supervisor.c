@@ -0,0 +1,77 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault Tolerance Demo - Replica Supervisor
+ *
+ * Supervisor of the standby build: parent of the primary and the standby
+ * server and of the client. When the active server faults, fault() here
+ * makes the other one active, aborts the client's call to the faulted one
+ * if it is blocked in it, and restarts the faulted server on a fresh
+ * stack as the new standby. The client's failover_ppcall() then reissues
+ * the call (see failover.h).
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "failover.h"
+#include "mttr.h"
+#include "pd_snapshot.h"
+#include "replica.h"
+
+#define PRIMARY_ID 1
+#define STANDBY_ID 2
+#define CLIENT_ID 3
+
+uintptr_t state_vaddr;
+#define STATE ((volatile struct replica_state *)state_vaddr)
+
+uintptr_t status_vaddr;
+#define STATUS ((volatile struct failover_status *)status_vaddr)
+
+void init(void)
+{
+    microkit_dbg_puts("SUPERVISOR|INFO: Supervising primary and standby servers\n");
+    STATUS->active = 0;
+}
+
+void notified(microkit_channel ch)
+{
+}
+
+seL4_Bool fault(microkit_child child, microkit_msginfo msginfo, microkit_msginfo *reply_msginfo)
+{
+    uint64_t entry = timing_now();
+
+    if (child != PRIMARY_ID && child != STANDBY_ID) {
+        microkit_dbg_puts("SUPERVISOR|ERROR: fault from unexpected child, stopping it\n");
+        microkit_pd_stop(child);
+        return seL4_False;
+    }
+
+    uint32_t server = child - PRIMARY_ID;
+
+    if (STATUS->failovers == 0) {
+        microkit_dbg_puts("SUPERVISOR|INFO: ");
+        microkit_dbg_puts(server == 0 ? "primary" : "standby");
+        microkit_dbg_puts(" faulted (fault label=");
+        dbg_put_u64(microkit_msginfo_get_label(msginfo));
+        microkit_dbg_puts("), failing over\n");
+    }
+
+    STATUS->active = !server;
+    STATE->served = 0;
+    if (STATUS->calling == server + 1) {
+        failover_abort_call(CLIENT_ID);
+    }
+    /* Only after the abort: the faulted server's reply object held the client's call */
+    pd_snapshot_restart(child);
+
+    STATUS->fault_time = STATE->fault_time;
+    STATUS->handler_time = entry;
+    STATUS->resume_time = timing_now();
+    STATUS->failovers++;
+
+    /* Restarted explicitly, so no reply */
+    return seL4_False;
+}
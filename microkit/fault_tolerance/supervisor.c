@@ -0,0 +1,142 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Fault Tolerance Demo - Supervisor Component
+ *
+ * Parent of the crasher, following the SDK's hierarchy/restarter.c: the
+ * crasher's faults are delivered to fault() here rather than to the
+ * monitor, and the crasher is restarted each time until FAULT_COUNT
+ * recoveries have been timed. Then it is stopped and the mean time to
+ * recovery is reported, split into:
+ *
+ *   fault_to_handler    crasher's last instruction to fault() entry
+ *   handler_to_restart  fault() entry to pd_snapshot_restart() returning
+ *   restart_to_served   restart to the crasher's first request being
+ *                       answered by the server
+ *
+ * The crasher restores its .data and .bss from the snapshot region this
+ * PD owns (see pd_snapshot.h); that restore is part of restart_to_served
+ * and is also reported on its own, with the pages it copied back. The
+ * crasher sends the segment on its first boot, through protected(), and
+ * maps the region read-only.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "stats.h"
+#include "mttr.h"
+#include "pd_snapshot.h"
+
+#define CRASHER_ID 1
+#define CRASHER_CH 0
+
+#ifndef FAULT_COUNT
+#define FAULT_COUNT 100
+#endif
+
+uintptr_t mttr_vaddr;
+#define SHARED ((volatile struct mttr_shared *)mttr_vaddr)
+
+uintptr_t snapshot_vaddr;
+uint64_t snapshot_size;
+#define SNAPSHOT ((volatile struct pd_snapshot_header *)snapshot_vaddr)
+
+static uint64_t fault_to_handler[FAULT_COUNT];
+static uint64_t handler_to_restart[FAULT_COUNT];
+static uint64_t restart_to_served[FAULT_COUNT];
+static uint64_t total[FAULT_COUNT];
+static uint64_t restore[FAULT_COUNT];
+static uint64_t restored_pages;
+
+static unsigned faults;
+static uint64_t restart_time;
+
+static void report(const char *phase, uint64_t *v, unsigned n)
+{
+    struct stats_summary s = stats_summarize_u64(v, n);
+
+    microkit_dbg_puts("SUPERVISOR|METRIC: phase=");
+    microkit_dbg_puts(phase);
+    dbg_put_kv("faults", n);
+    dbg_put_kv("min_ns", timing_ticks_to_ns(s.min));
+    dbg_put_kv("p50_ns", timing_ticks_to_ns(s.p50));
+    dbg_put_kv("p99_ns", timing_ticks_to_ns(s.p99));
+    dbg_put_kv("max_ns", timing_ticks_to_ns(s.max));
+    dbg_put_kv("avg_ns", timing_ticks_to_ns(s.avg));
+    microkit_dbg_puts("\n");
+}
+
+void init(void)
+{
+    microkit_dbg_puts("SUPERVISOR|INFO: Supervising crasher,");
+    dbg_put_kv("faults", FAULT_COUNT);
+    microkit_dbg_puts("\n");
+    SHARED->round = 0;
+}
+
+void notified(microkit_channel ch)
+{
+}
+
+microkit_msginfo protected(microkit_channel ch, microkit_msginfo msginfo)
+{
+    if (ch != CRASHER_CH) {
+        microkit_dbg_puts("SUPERVISOR|ERROR: call on unexpected channel\n");
+        return microkit_msginfo_new(PD_SNAPSHOT_REFUSED, 0);
+    }
+    return pd_snapshot_protected(snapshot_vaddr, snapshot_size, msginfo);
+}
+
+seL4_Bool fault(microkit_child child, microkit_msginfo msginfo, microkit_msginfo *reply_msginfo)
+{
+    uint64_t entry = timing_now();
+
+    if (child != CRASHER_ID) {
+        microkit_dbg_puts("SUPERVISOR|ERROR: fault from unexpected child, stopping it\n");
+        microkit_pd_stop(child);
+        return seL4_False;
+    }
+
+    if (faults == 0) {
+        microkit_dbg_puts("SUPERVISOR|INFO: crasher faulted (fault label=");
+        dbg_put_u64(microkit_msginfo_get_label(msginfo));
+        microkit_dbg_puts("), restarting it\n");
+    }
+
+    /* This fault ends the previous recovery: the crasher was served before faulting again */
+    if (SHARED->round > 0) {
+        unsigned prev = faults - 1;
+        restart_to_served[prev] = SHARED->served_time - restart_time;
+        total[prev] = fault_to_handler[prev] + handler_to_restart[prev] + restart_to_served[prev];
+        restore[prev] = SHARED->restore_ticks;
+        restored_pages += SHARED->restored_pages;
+    }
+
+    if (faults == FAULT_COUNT) {
+        microkit_pd_stop(child);
+        report("fault_to_handler", fault_to_handler, FAULT_COUNT);
+        report("handler_to_restart", handler_to_restart, FAULT_COUNT);
+        report("restart_to_served", restart_to_served, FAULT_COUNT);
+        report("total", total, FAULT_COUNT);
+        report("restore", restore, FAULT_COUNT);
+        microkit_dbg_puts("SUPERVISOR|METRIC: snapshot");
+        dbg_put_kv("pages", SNAPSHOT->pages);
+        dbg_put_kv("restores", FAULT_COUNT);
+        dbg_put_kv("restored_pages", restored_pages);
+        dbg_put_kv("stale_boots", SHARED->stale_boots);
+        microkit_dbg_puts("\n");
+        microkit_dbg_puts("SUPERVISOR|INFO: crasher stopped after measured recoveries\n");
+        return seL4_False;
+    }
+
+    fault_to_handler[faults] = entry - SHARED->fault_time;
+    SHARED->round = faults + 1;
+    pd_snapshot_restart(child);
+    restart_time = timing_now();
+    handler_to_restart[faults] = restart_time - entry;
+    faults++;
+
+    /* We explicitly restart the thread so we do not need to 'reply' to the fault. */
+    return seL4_False;
+}
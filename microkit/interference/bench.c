@@ -0,0 +1,177 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Interference Benchmark
+ *
+ * Measures the client/server IPC of ipc_demo, without its logging, while
+ * one noisy neighbour at a time runs alongside:
+ *
+ *   none           nothing else runs
+ *   cache_thrash   sweeps a region larger than the caches
+ *   membw          copies one large buffer to another
+ *   syscall_storm  enters the kernel back to back
+ *
+ * Every SAMPLE_PERIOD_US the EL1 physical timer (PPI 30) wakes this PD,
+ * which times one protected call to the server and one notification
+ * round trip: notify the server, which notifies straight back, timed to
+ * entry into notified(). The loads run whenever this PD is idle, or
+ * preempt it, depending on the priority and budget they were built with
+ * (see the Makefile).
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+#include "stats.h"
+#include "interference.h"
+
+#define IRQ_CH 0
+#define SERVER_CH 1
+#define CACHE_THRASH_CH 2
+#define MEMBW_CH 3
+#define SYSCALL_STORM_CH 4
+
+#define CNTP_CTL_ENABLE (1 << 0)
+
+#define SAMPLES 2000
+
+#ifndef SAMPLE_PERIOD_US
+#define SAMPLE_PERIOD_US 200
+#endif
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct interference_control *)control_vaddr)
+
+static const microkit_channel load_channels[] = { 0, CACHE_THRASH_CH, MEMBW_CH, SYSCALL_STORM_CH };
+
+static enum load load;
+static unsigned count;
+static uint64_t next_sample;
+static uint64_t period_ticks;
+static uint64_t notify_start;
+static uint64_t load_start_iterations;
+static uint32_t ppcall_samples[SAMPLES];
+static uint32_t notify_samples[SAMPLES];
+
+static uint64_t freq;
+
+static inline void arm_timer(uint64_t cval)
+{
+    __asm__ volatile("msr cntp_cval_el0, %0" : : "r" (cval));
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" ((uint64_t)CNTP_CTL_ENABLE));
+}
+
+static inline void disarm_timer(void)
+{
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" ((uint64_t)0));
+}
+
+static void report(const char *op, uint32_t *samples)
+{
+    struct stats_summary s = stats_summarize_u32(samples, SAMPLES);
+
+    microkit_dbg_puts("INTERFERENCE|METRIC: load=");
+    microkit_dbg_puts(load_names[load]);
+    microkit_dbg_puts(" op=");
+    microkit_dbg_puts(op);
+    dbg_put_kv("samples", SAMPLES);
+    dbg_put_kv("load_iterations", CONTROL->iterations[load] - load_start_iterations);
+    dbg_put_kv("min_ns", timing_ticks_to_ns(s.min));
+    dbg_put_kv("p50_ns", timing_ticks_to_ns(s.p50));
+    dbg_put_kv("p99_ns", timing_ticks_to_ns(s.p99));
+    dbg_put_kv("p999_ns", timing_ticks_to_ns(s.p999));
+    dbg_put_kv("max_ns", timing_ticks_to_ns(s.max));
+    dbg_put_kv("avg_ns", timing_ticks_to_ns(s.avg));
+    microkit_dbg_puts("\n");
+}
+
+static void start_load(void)
+{
+    load_start_iterations = CONTROL->iterations[load];
+    /* The previous load sees this and returns to its event loop */
+    CONTROL->active = load;
+    if (load != LOAD_NONE) {
+        microkit_notify(load_channels[load]);
+    }
+}
+
+static void schedule_next(void)
+{
+    uint64_t now = timing_now();
+
+    /* Keep the sampling rate, but never queue up samples behind a slow one */
+    do {
+        next_sample += period_ticks;
+    } while (next_sample <= now);
+    arm_timer(next_sample);
+}
+
+static void sample_ppcall(void)
+{
+    uint64_t start = timing_now();
+    (void) microkit_ppcall(SERVER_CH, microkit_msginfo_new(0, 0));
+    ppcall_samples[count] = timing_now() - start;
+
+    notify_start = timing_now();
+    microkit_notify(SERVER_CH);
+}
+
+static void sample_notify(void)
+{
+    notify_samples[count++] = timing_now() - notify_start;
+
+    if (count < SAMPLES) {
+        schedule_next();
+        return;
+    }
+
+    report("ppcall", ppcall_samples);
+    report("notify_rtt", notify_samples);
+
+    count = 0;
+    if (++load == NUM_LOADS) {
+        CONTROL->active = LOAD_NONE;
+        microkit_dbg_puts("INTERFERENCE|INFO: done\n");
+        return;
+    }
+    start_load();
+    schedule_next();
+}
+
+void init(void)
+{
+    freq = timing_freq();
+    period_ticks = SAMPLE_PERIOD_US * freq / 1000000;
+
+    microkit_dbg_puts("INTERFERENCE|INFO: starting");
+    dbg_put_kv("freq_hz", freq);
+    dbg_put_kv("sample_period_us", SAMPLE_PERIOD_US);
+    microkit_dbg_puts("\n");
+
+    disarm_timer();
+    load = LOAD_NONE;
+    start_load();
+    next_sample = timing_now();
+    schedule_next();
+}
+
+void notified(microkit_channel ch)
+{
+    switch (ch) {
+        case IRQ_CH:
+            /* Level triggered: disable the comparator before the ack */
+            disarm_timer();
+            microkit_irq_ack(ch);
+            sample_ppcall();
+            break;
+
+        case SERVER_CH:
+            sample_notify();
+            break;
+
+        default:
+            microkit_dbg_puts("INTERFERENCE|ERROR: notification on unexpected channel\n");
+            break;
+    }
+}
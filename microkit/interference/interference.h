@@ -0,0 +1,33 @@
+/*
+ * Copyright 2025
+ * Control page shared between the interference benchmark and its loads
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+
+enum load {
+    LOAD_NONE,
+    /* Reads and writes a line in every 64 bytes of a region larger than the caches */
+    LOAD_CACHE_THRASH,
+    /* Copies one half of a large region to the other, over and over */
+    LOAD_MEMBW,
+    /* Enters the kernel as fast as it can */
+    LOAD_SYSCALL_STORM,
+    NUM_LOADS,
+};
+
+static const char *const load_names[] = { "none", "cache_thrash", "membw", "syscall_storm" };
+
+struct interference_control {
+    /*
+     * Set before a load PD is notified; the load runs until it changes.
+     * A flag would not do: a preempted load could miss it being cleared
+     * and set again for the next one.
+     */
+    uint32_t active;
+    /* Work done by each load, to show it actually ran */
+    uint64_t iterations[NUM_LOADS];
+};
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Interference Benchmark - Memory Bandwidth Hog
+ *
+ * Copies the first half of its region to the second half with memcpy,
+ * from the benchmark's notification until it moves on to
+ * the next load.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "memops.h"
+#include "interference.h"
+
+#define BENCH_CH 0
+
+/* Per memcpy call, so the active load is checked often */
+#define CHUNK_SIZE 0x10000
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct interference_control *)control_vaddr)
+
+uintptr_t membw_vaddr;
+uint64_t membw_size;
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != BENCH_CH) {
+        return;
+    }
+
+    uint64_t half = membw_size / 2;
+    while (CONTROL->active == LOAD_MEMBW) {
+        for (uint64_t off = 0; off < half && CONTROL->active == LOAD_MEMBW; off += CHUNK_SIZE) {
+            memcpy((void *)(membw_vaddr + half + off), (const void *)(membw_vaddr + off), CHUNK_SIZE);
+        }
+        CONTROL->iterations[LOAD_MEMBW]++;
+    }
+}
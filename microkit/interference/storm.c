@@ -0,0 +1,33 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Interference Benchmark - Syscall Storm
+ *
+ * Yields in a loop from the benchmark's notification until it moves on
+ * to the next load. Nothing else runs at its priority, so each yield is
+ * a bare kernel entry and exit through the scheduler.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "interference.h"
+
+#define BENCH_CH 0
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct interference_control *)control_vaddr)
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != BENCH_CH) {
+        return;
+    }
+    while (CONTROL->active == LOAD_SYSCALL_STORM) {
+        seL4_Yield();
+        CONTROL->iterations[LOAD_SYSCALL_STORM]++;
+    }
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Interference Benchmark - Cache Thrasher
+ *
+ * Sweeps its region a cache line at a time, reading and writing each
+ * line, from the benchmark's notification until it moves on to
+ * the next load.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "interference.h"
+
+#define BENCH_CH 0
+
+#define LINE_SIZE 64
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct interference_control *)control_vaddr)
+
+uintptr_t thrash_vaddr;
+uint64_t thrash_size;
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != BENCH_CH) {
+        return;
+    }
+    while (CONTROL->active == LOAD_CACHE_THRASH) {
+        for (uintptr_t off = 0; off < thrash_size && CONTROL->active == LOAD_CACHE_THRASH; off += LINE_SIZE) {
+            volatile uint64_t *line = (volatile uint64_t *)(thrash_vaddr + off);
+            *line = *line + 1;
+        }
+        CONTROL->iterations[LOAD_CACHE_THRASH]++;
+    }
+}
@@ -6,11 +6,32 @@
  */
 #include <stdint.h>
 #include <microkit.h>
+#include "memops.h"
+#include "dbg.h"
+#include "timing.h"
+#include "log_ring.h"
+#include "boot_time.h"
+#include "trace.h"
+#include "req_trace.h"
+#include "hwm.h"
 
 #define SERVER_CH 0
 #define LOGGER_CH 1
 #define SHARED_MEMORY_SIZE 4096
 
+/* Label of the null call the server answers straight away */
+#define IPC_PING 3
+
+/* Label of the end-of-run call that has the server report its peaks */
+#define IPC_REPORT 4
+
+#ifndef PING_ROUNDS
+#define PING_ROUNDS 1000
+#endif
+
+/* This PD's id in the logger's heads page */
+#define CLIENT_LOG 0
+
 /* Shared memory region (mapped by system) */
 /* The system.system file sets setvar_vaddr="shared_buffer" which creates a uintptr_t variable */
 /* Default to 0, Microkit tool will patch this with actual virtual address */
@@ -19,26 +40,86 @@ uintptr_t shared_buffer = 0;
 /* Helper macro to access shared memory as a char array */
 #define SHARED_BUF ((char *)shared_buffer)
 
-/* Simple cycle counter read for ARM */
-static inline uint64_t read_cycle_counter(void)
+/* Own log ring, read by the logger, and the logger's heads page */
+uintptr_t log_ring_vaddr;
+uintptr_t log_heads_vaddr;
+
+static struct log_producer log_out = { .id = CLIENT_LOG, .ch = LOGGER_CH };
+
+/* Own trace buffer, dumped by the logger */
+uintptr_t trace_vaddr;
+
+/* Per-request hop timestamps, shared with the server and the logger */
+uintptr_t req_trace_vaddr;
+#define REQ ((volatile struct req_trace *)req_trace_vaddr)
+
+static uint64_t next_req = 1;
+
+/* Painted in init(); see hwm.h */
+static struct hwm_stack stack;
+
+/* Give the next request an id and stamp its first hop */
+static uint64_t req_start(enum req_path path)
 {
-    uint64_t val;
-    /* Use physical counter (CNTPC_EL0) which is exported to EL0 */
-    __asm__ volatile("mrs %0, cntpct_el0" : "=r" (val));
-    return val;
+    uint64_t id = next_req++;
+    volatile struct req_record *r = req_record(REQ, id);
+
+    for (unsigned hop = 0; hop < NUM_HOPS; hop++) {
+        r->t[hop] = 0;
+    }
+    r->id = id;
+    r->path = path;
+    r->t[HOP_CLIENT_SEND] = timing_now();
+    return id;
 }
 
-/* Convert cycles to nanoseconds */
-static uint64_t cycles_to_ns(uint64_t cycles)
+static void req_done(uint64_t id)
 {
-    uint64_t freq;
-    __asm__ volatile("mrs %0, cntfrq_el0" : "=r" (freq));
-    return (cycles * 1000000000ULL) / freq;
+    req_record(REQ, id)->t[HOP_CLIENT_DONE] = timing_now();
+}
+
+/*
+ * Time PING_ROUNDS back-to-back null calls, which the server answers
+ * without logging. A single call is only a few counter ticks, fewer on
+ * RISC-V's 10 MHz timebase, so this is the figure to compare across
+ * architectures.
+ */
+static void measure_ppcall(void)
+{
+    uint64_t start = timing_now();
+    for (unsigned i = 0; i < PING_ROUNDS; i++) {
+        (void) microkit_ppcall(SERVER_CH, microkit_msginfo_new(IPC_PING, 0));
+    }
+    uint64_t ticks = timing_now() - start;
+
+    microkit_dbg_puts("CLIENT|METRIC: counter=");
+    microkit_dbg_puts(timing_source());
+    dbg_put_kv("freq_hz", timing_freq());
+    dbg_put_kv("ppcall_rounds", PING_ROUNDS);
+    dbg_put_kv("ppcall_avg_ns", timing_ticks_to_ns(ticks) / PING_ROUNDS);
+    microkit_dbg_puts("\n");
+}
+
+/*
+ * End of the run: the server reports its stack and shared_mem peaks, this
+ * PD its stack; the logger reports its own and the log rings' as it
+ * drains the final batch.
+ */
+static void report_peaks(void)
+{
+    (void) microkit_ppcall(SERVER_CH, microkit_msginfo_new(IPC_REPORT, 0));
+    hwm_report("client", "stack", hwm_stack_peak(&stack), HWM_STACK_SIZE);
 }
 
 void init(void)
 {
-    microkit_dbg_puts("CLIENT|INFO: Initializing client component\n");
+    uint64_t boot_entry = boot_init_entry();
+
+    hwm_stack_paint(&stack);
+    log_out.ring = (volatile struct log_ring *)log_ring_vaddr;
+    log_out.heads = (const volatile struct log_heads *)log_heads_vaddr;
+    trace_begin("init");
+    log_text(&log_out, "Initializing client component");
     
     /* Wait a bit to ensure server is ready - simple delay loop */
     for (volatile int i = 0; i < 2000000; i++) {
@@ -46,13 +127,18 @@ void init(void)
     }
 
     /* Send initial message to server with timing */
-    uint64_t start_cycles = read_cycle_counter();
-    microkit_msginfo msg = microkit_msginfo_new(1, 1); /* label=1, count=1 */
-    microkit_dbg_puts("CLIENT|INFO: Sending message to server (label=1)\n");
+    uint64_t start_cycles = timing_now();
+    log_value(&log_out, "Sending message to server, label", 1);
+    uint64_t req = req_start(PATH_CALL_1);
+    microkit_msginfo msg = microkit_msginfo_new(1, 1); /* label=1, MR0=request id */
+    microkit_mr_set(0, req);
+    trace_begin("ppcall");
     microkit_msginfo reply = microkit_ppcall(SERVER_CH, msg);
-    uint64_t end_cycles = read_cycle_counter();
+    trace_end("ppcall");
+    uint64_t end_cycles = timing_now();
+    req_done(req);
     
-    uint64_t latency_ns = cycles_to_ns(end_cycles - start_cycles);
+    uint64_t latency_ns = timing_ticks_to_ns(end_cycles - start_cycles);
     
     /* Output latency metric - CRITICAL for metrics extraction */
     microkit_dbg_puts("CLIENT|METRIC: latency=");
@@ -71,45 +157,55 @@ void init(void)
     microkit_dbg_puts(" ns\n");
     
     uint64_t reply_label = microkit_msginfo_get_label(reply);
-    microkit_dbg_puts("CLIENT|INFO: Received reply from server (label=");
-    microkit_dbg_putc('0' + reply_label);
-    microkit_dbg_puts(")\n");
+    log_value(&log_out, "Received reply from server, label", reply_label);
 
     /* Test shared memory communication - use shared_buffer directly */
     /* Microkit tool patches shared_buffer with correct address */
-    microkit_dbg_puts("CLIENT|INFO: Writing to shared memory\n");
-    const char *test_data = "Hello from client via shared memory!";
-    for (int i = 0; test_data[i] != '\0' && i < SHARED_MEMORY_SIZE - 1; i++) {
-        SHARED_BUF[i] = test_data[i];
-    }
+    log_text(&log_out, "Writing to shared memory");
+    req = req_start(PATH_SHM_NOTIFY);
+    static const char test_data[] = "Hello from client via shared memory!";
+    memcpy(SHARED_BUF, test_data, sizeof(test_data));
     SHARED_BUF[SHARED_MEMORY_SIZE - 1] = '\0';
     
     /* Notify server that data is ready */
-    microkit_dbg_puts("CLIENT|INFO: Notifying server about shared memory data\n");
+    log_text(&log_out, "Notifying server about shared memory data");
+    trace_instant("notify_server");
+    /* A notification carries no message registers */
+    REQ->notify_req = req;
     microkit_notify(SERVER_CH);
 
     /* Send another message with different label */
-    msg = microkit_msginfo_new(2, 0); /* label=2, count=0 */
-    microkit_dbg_puts("CLIENT|INFO: Sending second message (label=2)\n");
+    log_value(&log_out, "Sending second message, label", 2);
+    req = req_start(PATH_CALL_2);
+    msg = microkit_msginfo_new(2, 1); /* label=2, MR0=request id */
+    microkit_mr_set(0, req);
+    trace_begin("ppcall");
     reply = microkit_ppcall(SERVER_CH, msg);
+    trace_end("ppcall");
+    req_done(req);
     reply_label = microkit_msginfo_get_label(reply);
-    microkit_dbg_puts("CLIENT|INFO: Received reply (label=");
-    microkit_dbg_putc('0' + reply_label);
-    microkit_dbg_puts(")\n");
+    log_value(&log_out, "Received reply, label", reply_label);
+    log_text(&log_out, "Client initialization complete");
+    trace_end("init");
+
+    measure_ppcall();
+    report_peaks();
 
-    /* Notify logger */
-    microkit_dbg_puts("CLIENT|INFO: Notifying logger\n");
-    microkit_notify(LOGGER_CH);
+    /* Everything above reaches the logger as one batch */
+    log_flush(&log_out);
 
-    microkit_dbg_puts("CLIENT|INFO: Client initialization complete\n");
+    boot_init_exit("client", boot_entry);
 }
 
 void notified(microkit_channel ch)
 {
     if (ch == SERVER_CH) {
-        microkit_dbg_puts("CLIENT|INFO: Received notification from server\n");
+        trace_instant("server_notified");
+        log_text(&log_out, "Received notification from server");
+        log_flush(&log_out);
     } else if (ch == LOGGER_CH) {
-        microkit_dbg_puts("CLIENT|INFO: Received notification from logger\n");
+        log_text(&log_out, "Received notification from logger");
+        log_flush(&log_out);
     } else {
         microkit_dbg_puts("CLIENT|WARN: Received notification on unexpected channel\n");
     }
@@ -6,6 +6,8 @@
  */
 #include <stdint.h>
 #include <microkit.h>
+#include "memops.h"
+#include "timing.h"
 
 #define SERVER_CH 0
 #define LOGGER_CH 1
@@ -15,24 +17,6 @@
 uintptr_t shared_buffer = 0;
 #define SHARED_BUF ((char *)shared_buffer)
 
-/* High-resolution timestamp using CPU cycle counter (RDTSC equivalent) */
-static inline uint64_t read_cycle_counter(void)
-{
-    uint64_t val;
-    __asm__ volatile("mrs %0, cntpct_el0" : "=r"(val));
-    return val;
-}
-
-/* Convert cycle counter to nanoseconds (assuming 1GHz counter) */
-static uint64_t cycles_to_ns(uint64_t cycles)
-{
-    /* For ARM, CNTVCT_EL0 frequency is typically 62.5MHz or 100MHz
-     * We'll read the actual frequency from CNTFRQ_EL0 */
-    uint64_t freq;
-    __asm__ volatile("mrs %0, cntfrq_el0" : "=r" (freq));
-    return (cycles * 1000000000ULL) / freq;
-}
-
 void init(void)
 {
     microkit_dbg_puts("CLIENT|INFO: Initializing client component with metrics\n");
@@ -44,12 +28,12 @@ void init(void)
     
     for (int i = 0; i < iterations; i++) {
         /* Send initial message to server */
-        uint64_t start_cycles = read_cycle_counter();
+        uint64_t start_cycles = timing_now();
         microkit_msginfo msg = microkit_msginfo_new(1, 1);
         microkit_msginfo reply = microkit_ppcall(SERVER_CH, msg);
-        uint64_t end_cycles = read_cycle_counter();
+        uint64_t end_cycles = timing_now();
         
-        uint64_t latency_ns = cycles_to_ns(end_cycles - start_cycles);
+        uint64_t latency_ns = timing_ticks_to_ns(end_cycles - start_cycles);
         total_latency += latency_ns;
         if (latency_ns < min_latency) min_latency = latency_ns;
         if (latency_ns > max_latency) max_latency = latency_ns;
@@ -57,21 +41,19 @@ void init(void)
         uint64_t reply_label = microkit_msginfo_get_label(reply);
         
         /* Test shared memory communication */
-        const char *test_data = "Hello from client via shared memory!";
-        for (int j = 0; test_data[j] != '\0' && j < SHARED_MEMORY_SIZE - 1; j++) {
-            SHARED_BUF[j] = test_data[j];
-        }
+        static const char test_data[] = "Hello from client via shared memory!";
+        memcpy(SHARED_BUF, test_data, sizeof(test_data));
         SHARED_BUF[SHARED_MEMORY_SIZE - 1] = '\0';
         
         microkit_notify(SERVER_CH);
         
         /* Send another message */
-        start_cycles = read_cycle_counter();
+        start_cycles = timing_now();
         msg = microkit_msginfo_new(2, 0);
         reply = microkit_ppcall(SERVER_CH, msg);
-        end_cycles = read_cycle_counter();
+        end_cycles = timing_now();
         
-        latency_ns = cycles_to_ns(end_cycles - start_cycles);
+        latency_ns = timing_ticks_to_ns(end_cycles - start_cycles);
         total_latency += latency_ns;
         if (latency_ns < min_latency) min_latency = latency_ns;
         if (latency_ns > max_latency) max_latency = latency_ns;
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit IPC Demo - Key-Value Protocol
+ *
+ * The server keeps a key-value store (see lib/kv_table.h) that any PD
+ * with a protected-call channel to it can use. Each caller also shares
+ * one page with the server, its KV buffer, for values too big for
+ * message registers:
+ *
+ *   request   label KV_GET, KV_PUT or KV_DELETE
+ *             MR0      key length | value length << 16
+ *             MR1-2    key, up to KV_KEY_MAX bytes
+ *             MR3-6    KV_PUT only: the value if at most KV_INLINE_MAX
+ *                      bytes, otherwise it is at the start of the buffer
+ *   reply     label enum kv_status
+ *             MR0      KV_GET only: value length
+ *             MR1-4    the value if at most KV_INLINE_MAX bytes,
+ *                      otherwise the server copies it to the buffer
+ *
+ * The call is synchronous, so the buffer is the caller's again once it
+ * returns. The server neither logs nor traces these calls.
+ *
+ * The same operations also go asynchronously over an rpc_queue (see
+ * rpc_queue.h), many in flight at once, for values of up to
+ * KV_INLINE_MAX bytes:
+ *
+ *   request     op       KV_GET, KV_PUT or KV_DELETE
+ *               len      KV_MR0(key length, value length)
+ *               payload  the key, then from KV_KEY_MAX a KV_PUT's value
+ *   completion  status   enum kv_status
+ *               len      KV_GET only: value length
+ *               payload  KV_GET only: the value
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+#include "memops.h"
+#include "kv_table.h"
+#include "rpc_queue.h"
+
+/* Labels 1-4 are the demo's requests, the null call and the report */
+#define KV_GET 5
+#define KV_PUT 6
+#define KV_DELETE 7
+
+#define KV_INLINE_MAX 32
+#define KV_BUFFER_SIZE 0x1000
+
+#define KV_WORDS(len) (((len) + sizeof(uint64_t) - 1) / sizeof(uint64_t))
+#define KV_KEY_MRS KV_WORDS(KV_KEY_MAX)
+
+#define KV_MR0(key_len, val_len) ((uint64_t)(key_len) | (uint64_t)(val_len) << 16)
+#define KV_MR0_KEY_LEN(mr0) ((unsigned)((mr0) & 0xff))
+#define KV_MR0_VAL_LEN(mr0) ((unsigned)(((mr0) >> 16) & 0xffff))
+
+_Static_assert(KV_VALUE_MAX <= KV_BUFFER_SIZE, "a value must fit in the KV buffer");
+_Static_assert(KV_KEY_MAX + KV_INLINE_MAX <= RPC_PAYLOAD, "a key and an inline value must fit in a request");
+
+/* Pack bytes into consecutive message registers from first */
+static inline void kv_mrs_write(unsigned first, const void *bytes, unsigned len)
+{
+    for (unsigned w = 0; w < KV_WORDS(len); w++) {
+        uint64_t word = 0;
+        unsigned n = len - w * sizeof(word) < sizeof(word) ? len - w * sizeof(word) : sizeof(word);
+        memcpy(&word, (const uint8_t *)bytes + w * sizeof(word), n);
+        microkit_mr_set(first + w, word);
+    }
+}
+
+static inline void kv_mrs_read(unsigned first, void *bytes, unsigned len)
+{
+    for (unsigned w = 0; w < KV_WORDS(len); w++) {
+        uint64_t word = microkit_mr_get(first + w);
+        unsigned n = len - w * sizeof(word) < sizeof(word) ? len - w * sizeof(word) : sizeof(word);
+        memcpy((uint8_t *)bytes + w * sizeof(word), &word, n);
+    }
+}
+
+/* Caller side; buf is this PD's KV buffer */
+
+static inline enum kv_status kv_call_put(microkit_channel ch, uintptr_t buf, const void *key, unsigned key_len,
+                                         const void *val, unsigned val_len)
+{
+    unsigned count = 1 + KV_KEY_MRS;
+
+    microkit_mr_set(0, KV_MR0(key_len, val_len));
+    kv_mrs_write(1, key, key_len);
+    if (val_len <= KV_INLINE_MAX) {
+        kv_mrs_write(1 + KV_KEY_MRS, val, val_len);
+        count += KV_WORDS(val_len);
+    } else {
+        memcpy((void *)buf, val, val_len);
+    }
+    return microkit_msginfo_get_label(microkit_ppcall(ch, microkit_msginfo_new(KV_PUT, count)));
+}
+
+/* Copies at most max bytes of the value to val; *val_len is its full length */
+static inline enum kv_status kv_call_get(microkit_channel ch, uintptr_t buf, const void *key, unsigned key_len,
+                                         void *val, unsigned max, unsigned *val_len)
+{
+    microkit_mr_set(0, KV_MR0(key_len, 0));
+    kv_mrs_write(1, key, key_len);
+    microkit_msginfo reply = microkit_ppcall(ch, microkit_msginfo_new(KV_GET, 1 + KV_KEY_MRS));
+    enum kv_status status = microkit_msginfo_get_label(reply);
+    if (status != KV_OK) {
+        return status;
+    }
+
+    unsigned len = microkit_mr_get(0);
+    *val_len = len;
+    if (len > max) {
+        len = max;
+    }
+    if (*val_len <= KV_INLINE_MAX) {
+        kv_mrs_read(1, val, len);
+    } else {
+        memcpy(val, (const void *)buf, len);
+    }
+    return KV_OK;
+}
+
+static inline enum kv_status kv_call_delete(microkit_channel ch, const void *key, unsigned key_len)
+{
+    microkit_mr_set(0, KV_MR0(key_len, 0));
+    kv_mrs_write(1, key, key_len);
+    return microkit_msginfo_get_label(microkit_ppcall(ch, microkit_msginfo_new(KV_DELETE, 1 + KV_KEY_MRS)));
+}
@@ -0,0 +1,570 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit IPC Demo - Key-Value Load Generator
+ *
+ * A YCSB-style closed loop against the server's key-value store (see
+ * kv.h). It loads KV_RECORDS records, then runs KV_OPS operations of
+ * each core workload:
+ *
+ *   a  50% get, 50% put (update heavy)
+ *   b  95% get,  5% put (read mostly)
+ *   c  100% get         (read only)
+ *
+ * choosing keys from a scrambled Zipfian distribution, as YCSB does by
+ * default, so a few records take most of the operations. It does all of
+ * this twice: with KV_SMALL_VALUE-byte values, which travel in message
+ * registers, and with YCSB's KV_LARGE_VALUE-byte records, which go
+ * through the shared KV buffer. For each workload and value size it
+ * prints
+ *
+ *   KV|METRIC: workload=a value_bytes=24 op=get ops=... p50_ns=... p90_ns=...
+ *              p99_ns=... p999_ns=... max_ns=...
+ *   KV|METRIC: workload=a value_bytes=24 op=all ops=... ops_per_sec=... errors=...
+ *
+ * Each operation is timed on its own; throughput is over the whole loop.
+ * errors counts failed calls and gets that returned another record's
+ * value.
+ *
+ * It then compares protected calls with asynchronous requests on an
+ * rpc_queue (see rpc_queue.h), running workload A's mix with small
+ * values KV_OPS times at each queue depth in rpc_runs, plus once with
+ * protected calls:
+ *
+ *   RPC|METRIC: mode=async depth=8 ops=... ops_per_sec=... p50_ns=... p99_ns=...
+ *               notifies=... wakeups=... errors=...
+ *
+ * These runs fill every free slot and then publish the lot. Two more, at
+ * depth 64, reap completions and submit as they go, like a client with a
+ * steady stream of work: "unbatched" calls rpc_submit() after each
+ * request, and "adaptive" hands each to rpc_batch.h, which holds requests
+ * back while earlier ones are outstanding, for at most RPC_BATCH_DELAY_US
+ * and while completion latency stays under RPC_BATCH_BUDGET_US. That run
+ * also reports the batches it submitted and the size it settled on:
+ *
+ *   RPC|METRIC: mode=adaptive depth=64 ... errors=... batches=... batch_target=...
+ *
+ * Latency runs from the request being written to the completion being
+ * read, so it includes any time held back. notifies counts notifications
+ * to the server and wakeups those from it: the queue notifies only a peer
+ * that may be asleep. Waiting for completions means returning to the
+ * event loop, so the async runs carry on from notified() once init() has
+ * had to return.
+ *
+ * It runs below the client, so after the demo, and at the end has the
+ * server report its peaks again (see hwm.h).
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "memops.h"
+#include "dbg.h"
+#include "timing.h"
+#include "boot_time.h"
+#include "hwm.h"
+#include "kv.h"
+#include "rpc_batch.h"
+
+#define SERVER_CH 0
+#define RPC_CH 1
+
+/* Label of the call that has the server report its peaks */
+#define IPC_REPORT 4
+
+/* A power of two, at most KV_MAX_LOAD */
+#ifndef KV_RECORDS
+#define KV_RECORDS 256
+#endif
+
+#ifndef KV_OPS
+#define KV_OPS 10000
+#endif
+
+#define KV_SMALL_VALUE 24
+#define KV_LARGE_VALUE 1000
+
+/* Latency histogram, one bucket per counter tick; the last takes the rest */
+#define HIST_BUCKETS 4096
+
+_Static_assert((KV_RECORDS & (KV_RECORDS - 1)) == 0, "KV_RECORDS must be a power of two");
+_Static_assert(KV_RECORDS <= KV_MAX_LOAD, "KV_RECORDS must fit in the server's table");
+_Static_assert(KV_LARGE_VALUE <= KV_VALUE_MAX, "KV_LARGE_VALUE must fit in a table slot");
+
+/* KV buffer shared with the server */
+uintptr_t kv_buffer;
+
+/* Request and completion rings shared with the server */
+uintptr_t rpc_queue_vaddr;
+#define KV_RPC_SIZE 0x3000
+
+_Static_assert(sizeof(struct rpc_queue) <= KV_RPC_SIZE, "kv_rpc in system.system is too small");
+
+/* How a run submits the requests it writes */
+enum submit {
+    /* Fill every free slot, then publish them together */
+    SUBMIT_WINDOW,
+    /* rpc_submit() after each request */
+    SUBMIT_EACH,
+    /* rpc_batch_queued() after each request */
+    SUBMIT_ADAPTIVE,
+};
+
+struct rpc_run {
+    const char *mode;
+    /* At most RPC_QUEUE_SIZE */
+    unsigned depth;
+    enum submit submit;
+};
+
+static const struct rpc_run rpc_runs[] = {
+    { "async", 1, SUBMIT_WINDOW },
+    { "async", 2, SUBMIT_WINDOW },
+    { "async", 4, SUBMIT_WINDOW },
+    { "async", 8, SUBMIT_WINDOW },
+    { "async", 16, SUBMIT_WINDOW },
+    { "async", 32, SUBMIT_WINDOW },
+    { "async", 64, SUBMIT_WINDOW },
+    { "unbatched", 64, SUBMIT_EACH },
+    { "adaptive", 64, SUBMIT_ADAPTIVE },
+};
+#define RPC_RUNS (sizeof(rpc_runs) / sizeof(rpc_runs[0]))
+#define RPC_GET_PCT 50
+
+/* Adaptive batching: the longest a request is held back, and the completion latency to stay under */
+#ifndef RPC_BATCH_DELAY_US
+#define RPC_BATCH_DELAY_US 20
+#endif
+#ifndef RPC_BATCH_BUDGET_US
+#define RPC_BATCH_BUDGET_US 50
+#endif
+
+static struct rpc_client rpc = { .ch = RPC_CH };
+static struct rpc_batch batch;
+
+/* Progress of the async runs, which span wakeups */
+static unsigned rpc_run;
+static unsigned rpc_submitted;
+static unsigned rpc_completed;
+static uint64_t rpc_start;
+static uint64_t rpc_errors;
+static uint64_t rpc_notifies;
+static uint64_t rpc_wakeups;
+
+/* Per request in flight, indexed by id % RPC_QUEUE_SIZE */
+static uint64_t rpc_sent[RPC_QUEUE_SIZE];
+static uint32_t rpc_record[RPC_QUEUE_SIZE];
+static uint8_t rpc_op[RPC_QUEUE_SIZE];
+
+struct workload {
+    const char *name;
+    unsigned get_pct;
+};
+
+static const struct workload workloads[] = {
+    { "a", 50 },
+    { "b", 95 },
+    { "c", 100 },
+};
+
+enum op { OP_GET, OP_PUT, NUM_OPS };
+static const char *const op_names[NUM_OPS] = { "get", "put" };
+
+struct latency {
+    uint32_t hist[HIST_BUCKETS];
+    uint64_t count;
+    uint64_t max;
+};
+
+static struct latency latency[NUM_OPS];
+
+/* Cumulative Zipfian weights, rank i weighted 1/(i+1) */
+static uint64_t zipf_cdf[KV_RECORDS];
+
+static uint8_t value[KV_VALUE_MAX];
+static uint8_t got[KV_VALUE_MAX];
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+/* Painted in init(); see hwm.h */
+static struct hwm_stack stack;
+
+static uint64_t rng_next(void)
+{
+    /* xorshift64 */
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void zipf_init(void)
+{
+    uint64_t sum = 0;
+    for (unsigned i = 0; i < KV_RECORDS; i++) {
+        sum += (1ULL << 32) / (i + 1);
+        zipf_cdf[i] = sum;
+    }
+}
+
+/* A record, popular ones spread over the key space rather than adjacent */
+static unsigned zipf_next(void)
+{
+    uint64_t r = rng_next() % zipf_cdf[KV_RECORDS - 1];
+    unsigned lo = 0, hi = KV_RECORDS - 1;
+    while (lo < hi) {
+        unsigned mid = (lo + hi) / 2;
+        if (zipf_cdf[mid] > r) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    /* Multiplying by an odd constant permutes 0..KV_RECORDS-1 */
+    return (lo * 0x9e3779b1u) & (KV_RECORDS - 1);
+}
+
+/* "user" and eight hex digits, as YCSB names its records */
+static unsigned make_key(unsigned record, uint8_t *key)
+{
+    static const char hex[] = "0123456789abcdef";
+    memcpy(key, "user", 4);
+    for (unsigned i = 0; i < 8; i++) {
+        key[4 + i] = hex[(record >> (28 - 4 * i)) & 0xf];
+    }
+    return 12;
+}
+
+/* The record's number leads its value, so that a get can be checked */
+static void make_value(unsigned record, unsigned len)
+{
+    memset(value, (uint8_t)record, len);
+    memcpy(value, &record, sizeof(record));
+}
+
+static void record_latency(enum op op, uint64_t ticks)
+{
+    struct latency *l = &latency[op];
+    l->hist[ticks < HIST_BUCKETS ? ticks : HIST_BUCKETS - 1]++;
+    l->count++;
+    if (ticks > l->max) {
+        l->max = ticks;
+    }
+}
+
+/* Latency in ticks at or below which per_mille of the operations fall */
+static uint64_t percentile(const struct latency *l, unsigned per_mille)
+{
+    uint64_t target = (l->count * per_mille + 999) / 1000;
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < HIST_BUCKETS - 1; i++) {
+        seen += l->hist[i];
+        if (seen >= target) {
+            return i;
+        }
+    }
+    return l->max;
+}
+
+/* Latency in ticks at or below which per_mille of all gets and puts fall */
+static uint64_t percentile_all(unsigned per_mille)
+{
+    static struct latency all;
+
+    all.count = latency[OP_GET].count + latency[OP_PUT].count;
+    all.max = latency[OP_GET].max > latency[OP_PUT].max ? latency[OP_GET].max : latency[OP_PUT].max;
+    for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+        all.hist[i] = latency[OP_GET].hist[i] + latency[OP_PUT].hist[i];
+    }
+    return percentile(&all, per_mille);
+}
+
+static void report(const char *workload, unsigned value_len, uint64_t ticks, uint64_t errors)
+{
+    for (unsigned op = 0; op < NUM_OPS; op++) {
+        const struct latency *l = &latency[op];
+        if (l->count == 0) {
+            continue;
+        }
+        microkit_dbg_puts("KV|METRIC: workload=");
+        microkit_dbg_puts(workload);
+        dbg_put_kv("value_bytes", value_len);
+        microkit_dbg_puts(" op=");
+        microkit_dbg_puts(op_names[op]);
+        dbg_put_kv("ops", l->count);
+        dbg_put_kv("p50_ns", timing_ticks_to_ns(percentile(l, 500)));
+        dbg_put_kv("p90_ns", timing_ticks_to_ns(percentile(l, 900)));
+        dbg_put_kv("p99_ns", timing_ticks_to_ns(percentile(l, 990)));
+        dbg_put_kv("p999_ns", timing_ticks_to_ns(percentile(l, 999)));
+        dbg_put_kv("max_ns", timing_ticks_to_ns(l->max));
+        microkit_dbg_puts("\n");
+    }
+
+    uint64_t ops = latency[OP_GET].count + latency[OP_PUT].count;
+    microkit_dbg_puts("KV|METRIC: workload=");
+    microkit_dbg_puts(workload);
+    dbg_put_kv("value_bytes", value_len);
+    microkit_dbg_puts(" op=all");
+    dbg_put_kv("ops", ops);
+    dbg_put_kv("ops_per_sec", ticks ? ops * timing_freq() / ticks : 0);
+    dbg_put_kv("errors", errors);
+    microkit_dbg_puts("\n");
+}
+
+static int do_put(unsigned record, unsigned value_len)
+{
+    uint8_t key[KV_KEY_MAX];
+    unsigned key_len = make_key(record, key);
+
+    make_value(record, value_len);
+    uint64_t start = timing_now();
+    enum kv_status status = kv_call_put(SERVER_CH, kv_buffer, key, key_len, value, value_len);
+    record_latency(OP_PUT, timing_now() - start);
+    return status == KV_OK;
+}
+
+static int do_get(unsigned record, unsigned value_len)
+{
+    uint8_t key[KV_KEY_MAX];
+    unsigned key_len = make_key(record, key);
+    unsigned len = 0;
+    unsigned stored;
+
+    uint64_t start = timing_now();
+    enum kv_status status = kv_call_get(SERVER_CH, kv_buffer, key, key_len, got, sizeof(got), &len);
+    record_latency(OP_GET, timing_now() - start);
+
+    memcpy(&stored, got, sizeof(stored));
+    return status == KV_OK && len == value_len && stored == record;
+}
+
+static void run(const char *name, unsigned get_pct, unsigned ops, unsigned value_len, int load)
+{
+    uint64_t errors = 0;
+
+    memset(latency, 0, sizeof(latency));
+    uint64_t start = timing_now();
+    for (unsigned i = 0; i < ops; i++) {
+        if (load) {
+            errors += !do_put(i, value_len);
+            continue;
+        }
+        unsigned record = zipf_next();
+        if (rng_next() % 100 < get_pct) {
+            errors += !do_get(record, value_len);
+        } else {
+            errors += !do_put(record, value_len);
+        }
+    }
+    report(name, value_len, timing_now() - start, errors);
+}
+
+/* batched is NULL unless the run went through rpc_batch.h */
+static void report_rpc(const char *mode, unsigned depth, uint64_t ticks, uint64_t errors,
+                       uint64_t notifies, uint64_t wakeups, const struct rpc_batch *batched)
+{
+    uint64_t ops = latency[OP_GET].count + latency[OP_PUT].count;
+
+    microkit_dbg_puts("RPC|METRIC: mode=");
+    microkit_dbg_puts(mode);
+    dbg_put_kv("depth", depth);
+    dbg_put_kv("ops", ops);
+    dbg_put_kv("ops_per_sec", ticks ? ops * timing_freq() / ticks : 0);
+    dbg_put_kv("p50_ns", timing_ticks_to_ns(percentile_all(500)));
+    dbg_put_kv("p99_ns", timing_ticks_to_ns(percentile_all(990)));
+    dbg_put_kv("notifies", notifies);
+    dbg_put_kv("wakeups", wakeups);
+    dbg_put_kv("errors", errors);
+    if (batched) {
+        uint64_t batches = 0;
+        for (unsigned r = 0; r < RPC_FLUSH_REASONS; r++) {
+            batches += batched->flushes[r];
+        }
+        dbg_put_kv("batches", batches);
+        dbg_put_kv("batch_target", batched->target);
+    }
+    microkit_dbg_puts("\n");
+}
+
+/* The baseline: the same mix, one protected call at a time */
+static void rpc_sync(void)
+{
+    uint64_t errors = 0;
+
+    memset(latency, 0, sizeof(latency));
+    uint64_t start = timing_now();
+    for (unsigned i = 0; i < KV_OPS; i++) {
+        unsigned record = zipf_next();
+        if (rng_next() % 100 < RPC_GET_PCT) {
+            errors += !do_get(record, KV_SMALL_VALUE);
+        } else {
+            errors += !do_put(record, KV_SMALL_VALUE);
+        }
+    }
+    report_rpc("ppcall", 1, timing_now() - start, errors, 0, 0, 0);
+}
+
+static void rpc_begin(void)
+{
+    memset(latency, 0, sizeof(latency));
+    rpc_submitted = 0;
+    rpc_completed = 0;
+    rpc_errors = 0;
+    rpc_notifies = rpc.notifies;
+    rpc_wakeups = 0;
+    rpc_batch_init(&batch, &rpc, timing_freq() * RPC_BATCH_DELAY_US / 1000000,
+                   timing_freq() * RPC_BATCH_BUDGET_US / 1000000);
+    rpc_start = timing_now();
+}
+
+/* Fill in the next request; the caller submits the batch */
+static void rpc_queue_one(void)
+{
+    volatile struct rpc_sqe *sqe = rpc_sqe_next(&rpc);
+    unsigned record = zipf_next();
+    unsigned slot = rpc_submitted % RPC_QUEUE_SIZE;
+    uint8_t key[KV_KEY_MAX];
+    unsigned key_len = make_key(record, key);
+
+    rpc_op[slot] = rng_next() % 100 < RPC_GET_PCT ? OP_GET : OP_PUT;
+    rpc_record[slot] = record;
+    sqe->id = rpc_submitted++;
+    memcpy((void *)sqe->payload, key, key_len);
+    if (rpc_op[slot] == OP_GET) {
+        sqe->op = KV_GET;
+        sqe->len = KV_MR0(key_len, 0);
+    } else {
+        make_value(record, KV_SMALL_VALUE);
+        memcpy((void *)(sqe->payload + KV_KEY_MAX), value, KV_SMALL_VALUE);
+        sqe->op = KV_PUT;
+        sqe->len = KV_MR0(key_len, KV_SMALL_VALUE);
+    }
+    rpc_sent[slot] = timing_now();
+}
+
+static void rpc_reap(void)
+{
+    const volatile struct rpc_cqe *cqe;
+    uint64_t now = timing_now();
+
+    while ((cqe = rpc_cqe_next(&rpc)) != 0) {
+        unsigned slot = cqe->id % RPC_QUEUE_SIZE;
+        int ok = cqe->status == KV_OK;
+        if (ok && rpc_op[slot] == OP_GET) {
+            unsigned stored;
+            memcpy(&stored, (const void *)cqe->payload, sizeof(stored));
+            ok = cqe->len == KV_SMALL_VALUE && stored == rpc_record[slot];
+        }
+        rpc_errors += !ok;
+        record_latency(rpc_op[slot], now - rpc_sent[slot]);
+        rpc_batch_completed(&batch, now - rpc_sent[slot]);
+        rpc_completed++;
+    }
+    rpc_cqe_release(&rpc);
+}
+
+/* End of the run: have the server report its peaks, then report this PD's */
+static void finish(void)
+{
+    (void) microkit_ppcall(SERVER_CH, microkit_msginfo_new(IPC_REPORT, 0));
+    hwm_report("loadgen", "stack", hwm_stack_peak(&stack), HWM_STACK_SIZE);
+    hwm_report_region("loadgen", "kv_shared", kv_buffer, KV_BUFFER_SIZE);
+}
+
+/* Write requests until the run's depth is in flight or all KV_OPS are written, submitting as it says */
+static void rpc_fill(const struct rpc_run *r)
+{
+    while (rpc_submitted < KV_OPS) {
+        if (r->submit != SUBMIT_WINDOW) {
+            rpc_reap();
+        }
+        if (rpc_in_flight(&rpc) >= r->depth) {
+            break;
+        }
+        rpc_queue_one();
+        if (r->submit == SUBMIT_EACH) {
+            rpc_submit(&rpc);
+        } else if (r->submit == SUBMIT_ADAPTIVE) {
+            rpc_batch_queued(&batch, timing_now());
+        }
+    }
+    /* Nothing more to write until completions come back */
+    if (r->submit == SUBMIT_ADAPTIVE) {
+        rpc_batch_idle(&batch);
+    } else {
+        rpc_submit(&rpc);
+    }
+}
+
+/*
+ * Carry out rpc_runs[rpc_run] until KV_OPS requests have completed, then
+ * move on to the next run. Returns when it has to wait for completions,
+ * which arrive with a notification, or when it is done.
+ */
+static void rpc_pump(void)
+{
+    for (;;) {
+        const struct rpc_run *r = &rpc_runs[rpc_run];
+
+        rpc_reap();
+        if (r->submit == SUBMIT_ADAPTIVE) {
+            rpc_batch_idle(&batch);
+        }
+        rpc_fill(r);
+
+        if (rpc_completed == KV_OPS) {
+            report_rpc(r->mode, r->depth, timing_now() - rpc_start, rpc_errors,
+                       rpc.notifies - rpc_notifies, rpc_wakeups,
+                       r->submit == SUBMIT_ADAPTIVE ? &batch : 0);
+            if (++rpc_run == RPC_RUNS) {
+                finish();
+                return;
+            }
+            rpc_begin();
+            continue;
+        }
+
+        if (rpc_client_sleep(&rpc)) {
+            return;
+        }
+    }
+}
+
+void init(void)
+{
+    uint64_t boot_entry = boot_init_entry();
+
+    hwm_stack_paint(&stack);
+    /* The server writes it only when this PD calls */
+    hwm_paint(kv_buffer, KV_BUFFER_SIZE);
+    zipf_init();
+    microkit_dbg_puts("LOADGEN|INFO: YCSB-style load on the server's key-value store\n");
+    boot_init_exit("loadgen", boot_entry);
+
+    rpc.q = (volatile struct rpc_queue *)rpc_queue_vaddr;
+
+    /* Small values last: the async runs below need them inline */
+    static const unsigned value_lens[] = { KV_LARGE_VALUE, KV_SMALL_VALUE };
+    for (unsigned v = 0; v < sizeof(value_lens) / sizeof(value_lens[0]); v++) {
+        run("load", 0, KV_RECORDS, value_lens[v], 1);
+        for (unsigned w = 0; w < sizeof(workloads) / sizeof(workloads[0]); w++) {
+            run(workloads[w].name, workloads[w].get_pct, KV_OPS, value_lens[v], 0);
+        }
+    }
+
+    rpc_sync();
+    rpc_begin();
+    rpc_pump();
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != RPC_CH) {
+        microkit_dbg_puts("LOADGEN|WARN: Received notification on unexpected channel\n");
+        return;
+    }
+    if (rpc_run < RPC_RUNS) {
+        rpc_wakeups++;
+        rpc_batch_poll(&batch, timing_now());
+        rpc_pump();
+    }
+}
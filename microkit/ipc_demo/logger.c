@@ -2,57 +2,240 @@
  * Copyright 2025
  * seL4 Microkit Logger Component
  *
+ * The client and the server each write structured records into their own
+ * log ring (see log_ring.h) and notify once per batch. On each wakeup the
+ * logger prints every record in timestamp order, whichever channel fired.
+ * It can read the two rings and write the heads page, and nothing else:
+ * it still has no access to the client's or the server's own memory.
+ *
+ * Built with TRACE=1, it also prints the events the client, the server
+ * and it have traced since the last wakeup (see trace.h). It runs below
+ * both, so by the time it runs they have finished what the notification
+ * was about.
+ *
+ * It also stamps the last hop of each request the server has notified it
+ * about (see req_trace.h) and, once a request has every hop, reports the
+ * time spent in each:
+ *
+ *   client_to_server  client send to server entry (the call or notification)
+ *   server            server entry to exit
+ *   server_to_client  server exit to the call returning (calls only)
+ *   server_to_logger  server exit to this wakeup
+ *   total             client send to the call returning, or to server exit
+ *                     for a notification, which has no reply
+ *
+ * Finally, after each drain it reports any peak that has grown since the
+ * last: its own stack, the most records each log ring has held and, with
+ * TRACE=1, how full each trace buffer is (see hwm.h).
+ *
  * SPDX-License-Identifier: BSD-2-Clause
  */
 #include <stdint.h>
 #include <microkit.h>
+#include "dbg.h"
+#include "log_ring.h"
+#include "boot_time.h"
+#include "trace.h"
+#include "req_trace.h"
+#include "hwm.h"
 
 #define CLIENT_CH 0
 #define SERVER_CH 1
 
-#define LOG_BUFFER_SIZE 256
-static char log_buffer[LOG_BUFFER_SIZE];
-static int log_index = 0;
+/* Producer ids, i.e. indices into the heads page */
+#define CLIENT_LOG 0
+#define SERVER_LOG 1
+#define NUM_LOGS 2
+
+uintptr_t client_log_vaddr;
+uintptr_t server_log_vaddr;
+uintptr_t log_heads_vaddr;
+
+/* The producers' trace buffers (read-only) and this PD's own */
+uintptr_t client_trace_vaddr;
+uintptr_t server_trace_vaddr;
+uintptr_t trace_vaddr;
+
+static struct log_source sources[NUM_LOGS];
+static struct trace_source traces[NUM_LOGS + 1];
+static uint64_t log_count;
+
+/* Regions as named in system.system, indexed like sources and traces */
+static const char *const log_regions[NUM_LOGS] = { "client_log", "server_log" };
+static const char *const trace_regions[NUM_LOGS + 1] = { "client_trace", "server_trace", "logger_trace" };
+
+/* Painted in init(); see hwm.h */
+static struct hwm_stack stack;
+
+/* Peaks as last reported, so that each wakeup prints only what has grown */
+static uint64_t stack_reported;
+static uint64_t ring_reported[NUM_LOGS];
+static uint64_t trace_reported[NUM_LOGS + 1];
+
+/* Per-request hop timestamps, shared with the client and the server */
+uintptr_t req_trace_vaddr;
+#define REQ ((volatile struct req_trace *)req_trace_vaddr)
+
+/* Next request to report; they complete in the order the client makes them */
+static uint64_t next_report = 1;
+
+static uint64_t hop_ns(const volatile struct req_record *r, enum req_hop from, enum req_hop to)
+{
+    return timing_ticks_to_ns(r->t[to] - r->t[from]);
+}
+
+static void report_request(const volatile struct req_record *r)
+{
+    int call = r->path != PATH_SHM_NOTIFY;
+
+    microkit_dbg_puts("REQTRACE|METRIC:");
+    dbg_put_kv("req", r->id);
+    microkit_dbg_puts(" path=");
+    microkit_dbg_puts(r->path < NUM_PATHS ? path_names[r->path] : "unknown");
+    dbg_put_kv("client_to_server_ns", hop_ns(r, HOP_CLIENT_SEND, HOP_SERVER_ENTRY));
+    dbg_put_kv("server_ns", hop_ns(r, HOP_SERVER_ENTRY, HOP_SERVER_EXIT));
+    if (call) {
+        dbg_put_kv("server_to_client_ns", hop_ns(r, HOP_SERVER_EXIT, HOP_CLIENT_DONE));
+    }
+    dbg_put_kv("server_to_logger_ns", hop_ns(r, HOP_SERVER_EXIT, HOP_LOGGER));
+    dbg_put_kv("total_ns", hop_ns(r, HOP_CLIENT_SEND, call ? HOP_CLIENT_DONE : HOP_SERVER_EXIT));
+    microkit_dbg_puts("\n");
+}
+
+static void trace_requests(void)
+{
+    uint64_t now = timing_now();
+
+    for (unsigned i = 0; i < REQ_RECORDS; i++) {
+        volatile struct req_record *r = &REQ->req[i];
+        if (r->id != 0 && r->t[HOP_SERVER_EXIT] != 0 && r->t[HOP_LOGGER] == 0) {
+            r->t[HOP_LOGGER] = now;
+        }
+    }
+
+    for (;;) {
+        volatile struct req_record *r = req_record(REQ, next_report);
+        if (r->id != next_report || r->t[HOP_LOGGER] == 0 ||
+            (r->path != PATH_SHM_NOTIFY && r->t[HOP_CLIENT_DONE] == 0)) {
+            break;
+        }
+        report_request(r);
+        next_report++;
+    }
+}
 
-static void append_log(const char *msg)
+static void report_peaks(void)
 {
-    for (int i = 0; msg[i] != '\0' && log_index < LOG_BUFFER_SIZE - 1; i++) {
-        log_buffer[log_index++] = msg[i];
+    uint64_t peak = hwm_stack_peak(&stack);
+    if (peak > stack_reported) {
+        hwm_report("logger", "stack", peak, HWM_STACK_SIZE);
+        stack_reported = peak;
     }
-    if (log_index < LOG_BUFFER_SIZE - 1) {
-        log_buffer[log_index++] = '\n';
+
+    for (unsigned i = 0; i < NUM_LOGS; i++) {
+        uint64_t slots = sources[i].ring->peak;
+        if (slots > ring_reported[i]) {
+            hwm_report(sources[i].name, log_regions[i],
+                       sizeof(struct log_ring) + slots * sizeof(struct log_record), LOG_RING_SIZE);
+            ring_reported[i] = slots;
+        }
+    }
+
+    if (!TRACE) {
+        return;
+    }
+    for (unsigned i = 0; i < NUM_LOGS + 1; i++) {
+        /* The buffer fills once, so its count is its peak */
+        uint64_t events = traces[i].buf->count;
+        if (events > trace_reported[i]) {
+            hwm_report(traces[i].name, trace_regions[i],
+                       sizeof(struct trace_buffer) + events * sizeof(struct trace_event), TRACE_BUFFER_SIZE);
+            trace_reported[i] = events;
+        }
     }
-    log_buffer[LOG_BUFFER_SIZE - 1] = '\0';
+}
+
+static void print_record(const struct log_source *src, const volatile struct log_record *r)
+{
+    log_count++;
+    microkit_dbg_puts("LOGGER|INFO: [LOG #");
+    dbg_put_u64(log_count);
+    microkit_dbg_puts(" t=");
+    dbg_put_u64(timing_ticks_to_ns(r->timestamp));
+    microkit_dbg_puts("ns ");
+    microkit_dbg_puts(src->name);
+    microkit_dbg_puts("] ");
+    for (unsigned i = 0; i < LOG_TEXT_LEN && r->text[i] != '\0'; i++) {
+        microkit_dbg_putc(r->text[i]);
+    }
+    if (r->flags & LOG_RECORD_VALUE) {
+        microkit_dbg_putc('=');
+        dbg_put_u64(r->value);
+    }
+    microkit_dbg_puts("\n");
 }
 
 void init(void)
 {
+    uint64_t boot_entry = boot_init_entry();
+
+    hwm_stack_paint(&stack);
+
+    sources[CLIENT_LOG].ring = (const volatile struct log_ring *)client_log_vaddr;
+    sources[CLIENT_LOG].name = "client";
+    sources[SERVER_LOG].ring = (const volatile struct log_ring *)server_log_vaddr;
+    sources[SERVER_LOG].name = "server";
+
+    traces[CLIENT_LOG].buf = (const volatile struct trace_buffer *)client_trace_vaddr;
+    traces[CLIENT_LOG].name = "client";
+    traces[SERVER_LOG].buf = (const volatile struct trace_buffer *)server_trace_vaddr;
+    traces[SERVER_LOG].name = "server";
+    traces[NUM_LOGS].buf = (const volatile struct trace_buffer *)trace_vaddr;
+    traces[NUM_LOGS].name = "logger";
+
     microkit_dbg_puts("LOGGER|INFO: Initializing logger component\n");
-    microkit_dbg_puts("LOGGER|INFO: Logger has minimal capabilities (notifications only)\n");
+    microkit_dbg_puts("LOGGER|INFO: Logger maps only the producers' log rings (read-only)\n");
     microkit_dbg_puts("LOGGER|INFO: No memory access to client or server components\n");
-    append_log("Logger initialized");
+
+    boot_init_exit("logger", boot_entry);
 }
 
 void notified(microkit_channel ch)
 {
-    if (ch == CLIENT_CH) {
-        microkit_dbg_puts("LOGGER|INFO: Received notification from client\n");
-        append_log("Client notification");
-        microkit_dbg_puts("LOGGER|INFO: Log entry added\n");
-    } else if (ch == SERVER_CH) {
-        microkit_dbg_puts("LOGGER|INFO: Received notification from server\n");
-        append_log("Server notification");
-        microkit_dbg_puts("LOGGER|INFO: Log entry added\n");
-    } else {
+    if (ch != CLIENT_CH && ch != SERVER_CH) {
         microkit_dbg_puts("LOGGER|WARN: Received notification on unexpected channel\n");
+        return;
     }
 
-    /* Print current log buffer */
-    microkit_dbg_puts("LOGGER|INFO: Current log buffer:\n");
-    for (int i = 0; i < log_index && i < LOG_BUFFER_SIZE; i++) {
-        microkit_dbg_putc(log_buffer[i]);
+    trace_requests();
+
+    trace_begin("drain");
+    log_drain(sources, NUM_LOGS, (volatile struct log_heads *)log_heads_vaddr, print_record);
+
+    for (unsigned i = 0; i < NUM_LOGS; i++) {
+        uint64_t dropped = sources[i].ring->dropped;
+        if (dropped != sources[i].dropped_seen) {
+            microkit_dbg_puts("LOGGER|WARN: ");
+            microkit_dbg_puts(sources[i].name);
+            microkit_dbg_puts(" dropped");
+            dbg_put_kv("records", dropped - sources[i].dropped_seen);
+            microkit_dbg_puts("\n");
+            sources[i].dropped_seen = dropped;
+        }
+        if (sources[i].skipped != 0) {
+            microkit_dbg_puts("LOGGER|WARN: ");
+            microkit_dbg_puts(sources[i].name);
+            microkit_dbg_puts(" ring index out of range, skipped");
+            dbg_put_kv("records", sources[i].skipped);
+            microkit_dbg_puts("\n");
+            sources[i].skipped = 0;
+        }
     }
-    microkit_dbg_puts("\n");
-}
+    trace_end("drain");
 
+    for (unsigned i = 0; i < NUM_LOGS + 1; i++) {
+        trace_dump(&traces[i]);
+    }
 
+    report_peaks();
+}
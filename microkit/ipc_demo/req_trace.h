@@ -0,0 +1,72 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit IPC Demo - Per-Request Hop Timestamps
+ *
+ * Every request the client makes gets an id, which travels in MR0 of the
+ * protected call. A notification has no message registers, so for the
+ * shared-memory request the client leaves the id in notify_req before
+ * notifying. Each PD stamps its hops of a request into that request's
+ * record in the shared tracing region, writing only its own fields:
+ *
+ *   client  HOP_CLIENT_SEND   before the call or the notification
+ *           HOP_CLIENT_DONE   when the call returns (calls only)
+ *   server  HOP_SERVER_ENTRY  on entry to protected() or notified()
+ *           HOP_SERVER_EXIT   before notifying the logger of its records
+ *   logger  HOP_LOGGER        on the wakeup that follows
+ *
+ * Once a request has all its hops the logger reports the time between
+ * them (see logger.c). The counter is the one all PDs share, so stamps
+ * from different PDs compare directly.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+
+/* Records kept; a request's record is reused REQ_RECORDS requests later */
+#define REQ_RECORDS 64
+
+enum req_path {
+    PATH_NONE,
+    /* Protected call, label 1 */
+    PATH_CALL_1,
+    /* Protected call, label 2 */
+    PATH_CALL_2,
+    /* Shared-memory write and notification */
+    PATH_SHM_NOTIFY,
+    NUM_PATHS
+};
+
+static const char *const path_names[] = { "none", "call_1", "call_2", "shm_notify" };
+
+enum req_hop {
+    HOP_CLIENT_SEND,
+    HOP_SERVER_ENTRY,
+    HOP_SERVER_EXIT,
+    HOP_CLIENT_DONE,
+    HOP_LOGGER,
+    NUM_HOPS
+};
+
+struct req_record {
+    /* Written by the client before HOP_CLIENT_SEND */
+    uint64_t id;
+    uint64_t path;
+    /* Counter values, 0 until the hop is reached */
+    uint64_t t[NUM_HOPS];
+};
+
+struct req_trace {
+    /* Id of the request the latest client notification is about */
+    uint64_t notify_req;
+    uint64_t pad[7];
+    struct req_record req[REQ_RECORDS];
+};
+
+_Static_assert(sizeof(struct req_trace) <= 0x1000, "req_trace must fit its region");
+
+static inline volatile struct req_record *req_record(volatile struct req_trace *trace, uint64_t id)
+{
+    return &trace->req[id % REQ_RECORDS];
+}
@@ -2,15 +2,39 @@
  * Copyright 2025
  * seL4 Microkit IPC Server Component
  *
+ * Answers the client's demo requests and serves a key-value store over
+ * protected calls, from the client and from the load generator (see
+ * kv.h). The table lives in kv_store, a region only the server maps.
+ * The load generator can also queue requests on an rpc_queue, which the
+ * server drains whenever it is notified.
+ *
  * SPDX-License-Identifier: BSD-2-Clause
  */
 #include <stdint.h>
 #include <microkit.h>
+#include "memops.h"
+#include "log_ring.h"
+#include "boot_time.h"
+#include "trace.h"
+#include "req_trace.h"
+#include "hwm.h"
+#include "kv.h"
 
 #define CLIENT_CH 0
 #define LOGGER_CH 1
+#define LOADGEN_CH 2
+#define LOADGEN_RPC_CH 3
 #define SHARED_MEMORY_SIZE 4096
 
+/* Label of the client's null call, answered without logging or tracing */
+#define IPC_PING 3
+
+/* Label of the client's end-of-run call: report this PD's peaks */
+#define IPC_REPORT 4
+
+/* This PD's id in the logger's heads page */
+#define SERVER_LOG 1
+
 /* Shared memory region (mapped by system) */
 /* The system.system file sets setvar_vaddr="shared_buffer" which creates a uintptr_t variable */
 /* Default to 0, Microkit tool will patch this with actual virtual address */
@@ -19,63 +43,245 @@ uintptr_t shared_buffer = 0;
 /* Helper macro to access shared memory as a char array */
 #define SHARED_BUF ((char *)shared_buffer)
 
+/* Own log ring, read by the logger, and the logger's heads page */
+uintptr_t log_ring_vaddr;
+uintptr_t log_heads_vaddr;
+
+static struct log_producer log_out = { .id = SERVER_LOG, .ch = LOGGER_CH };
+
+/* Own trace buffer, dumped by the logger */
+uintptr_t trace_vaddr;
+
+/* Per-request hop timestamps, shared with the client and the logger */
+uintptr_t req_trace_vaddr;
+#define REQ ((volatile struct req_trace *)req_trace_vaddr)
+
+/* Key-value table, in a region of its own; zeroed, so empty to begin with */
+uintptr_t kv_store_vaddr;
+#define KV ((struct kv_table *)kv_store_vaddr)
+#define KV_STORE_SIZE 0x85000
+
+_Static_assert(sizeof(struct kv_table) <= KV_STORE_SIZE, "kv_store in system.system is too small");
+
+/* The load generator's KV buffer; the client uses shared_mem */
+uintptr_t kv_buffer;
+
+/* Request and completion rings shared with the load generator */
+uintptr_t rpc_queue_vaddr;
+
+static struct rpc_server rpc = { .ch = LOADGEN_RPC_CH };
+
+/* Painted in init(); see hwm.h */
+static struct hwm_stack stack;
+
+static void req_stamp(uint64_t id, enum req_hop hop)
+{
+    volatile struct req_record *r = req_record(REQ, id);
+
+    /* Ignore ids the client never started, e.g. from a call without MR0 */
+    if (id != 0 && r->id == id) {
+        r->t[hop] = timing_now();
+    }
+}
+
+static microkit_msginfo kv_serve(uint64_t label, uintptr_t buf)
+{
+    uint64_t mr0 = microkit_mr_get(0);
+    unsigned key_len = KV_MR0_KEY_LEN(mr0);
+    unsigned val_len = KV_MR0_VAL_LEN(mr0);
+    uint8_t key[KV_KEY_MAX];
+
+    if (key_len > KV_KEY_MAX) {
+        return microkit_msginfo_new(KV_TOO_BIG, 0);
+    }
+    kv_mrs_read(1, key, key_len);
+
+    switch (label) {
+    case KV_GET: {
+        unsigned len;
+        const uint8_t *val = kv_get(KV, key, key_len, &len);
+        if (val == 0) {
+            return microkit_msginfo_new(KV_NOT_FOUND, 0);
+        }
+        microkit_mr_set(0, len);
+        if (len <= KV_INLINE_MAX) {
+            kv_mrs_write(1, val, len);
+            return microkit_msginfo_new(KV_OK, 1 + KV_WORDS(len));
+        }
+        memcpy((void *)buf, val, len);
+        return microkit_msginfo_new(KV_OK, 1);
+    }
+
+    case KV_PUT: {
+        uint8_t inline_val[KV_INLINE_MAX];
+        const void *val = (const void *)buf;
+        if (val_len <= KV_INLINE_MAX) {
+            kv_mrs_read(1 + KV_KEY_MRS, inline_val, val_len);
+            val = inline_val;
+        }
+        return microkit_msginfo_new(kv_put(KV, key, key_len, val, val_len), 0);
+    }
+
+    default:
+        return microkit_msginfo_new(kv_delete(KV, key, key_len), 0);
+    }
+}
+
+static void kv_serve_rpc(const volatile struct rpc_sqe *sqe, volatile struct rpc_cqe *cqe)
+{
+    uint32_t op = sqe->op;
+    uint32_t len = sqe->len;
+    unsigned key_len = KV_MR0_KEY_LEN(len);
+    unsigned val_len = KV_MR0_VAL_LEN(len);
+    /* Copy the request out of shared memory once, so that what is checked is what is used */
+    uint8_t req[RPC_PAYLOAD];
+    memcpy(req, (const void *)sqe->payload, sizeof(req));
+
+    cqe->id = sqe->id;
+    cqe->len = 0;
+    if (key_len > KV_KEY_MAX || val_len > KV_INLINE_MAX) {
+        cqe->status = KV_TOO_BIG;
+        return;
+    }
+
+    switch (op) {
+    case KV_GET: {
+        unsigned found;
+        const uint8_t *val = kv_get(KV, req, key_len, &found);
+        if (val == 0) {
+            cqe->status = KV_NOT_FOUND;
+        } else if (found > KV_INLINE_MAX) {
+            cqe->status = KV_TOO_BIG;
+        } else {
+            memcpy((void *)cqe->payload, val, found);
+            cqe->len = found;
+            cqe->status = KV_OK;
+        }
+        break;
+    }
+
+    case KV_PUT:
+        cqe->status = kv_put(KV, req, key_len, req + KV_KEY_MAX, val_len);
+        break;
+
+    case KV_DELETE:
+        cqe->status = kv_delete(KV, req, key_len);
+        break;
+
+    default:
+        cqe->status = KV_INVALID;
+        break;
+    }
+}
+
+/* Serve everything queued, then sleep only if nothing more arrived meanwhile */
+static void serve_rpc(void)
+{
+    do {
+        const volatile struct rpc_sqe *sqe;
+        while ((sqe = rpc_sqe_peek(&rpc)) != 0) {
+            kv_serve_rpc(sqe, rpc_cqe_slot(&rpc));
+            rpc_complete(&rpc);
+        }
+        rpc_server_flush(&rpc);
+    } while (!rpc_server_sleep(&rpc));
+}
+
 microkit_msginfo protected(microkit_channel ch, microkit_msginfo msginfo)
 {
     uint64_t label = microkit_msginfo_get_label(msginfo);
+    microkit_msginfo reply;
+
+    if (label == IPC_PING) {
+        return microkit_msginfo_new(IPC_PING, 0);
+    }
+    if (label == IPC_REPORT) {
+        hwm_report("server", "stack", hwm_stack_peak(&stack), HWM_STACK_SIZE);
+        hwm_report_region("server", "shared_mem", shared_buffer, SHARED_MEMORY_SIZE);
+        return microkit_msginfo_new(IPC_REPORT, 0);
+    }
+    if (label >= KV_GET && label <= KV_DELETE) {
+        return kv_serve(label, ch == LOADGEN_CH ? kv_buffer : shared_buffer);
+    }
+    uint64_t req = microkit_msginfo_get_count(msginfo) > 0 ? microkit_mr_get(0) : 0;
 
-    microkit_dbg_puts("SERVER|INFO: Received protected call (label=");
-    microkit_dbg_putc('0' + label);
-    microkit_dbg_puts(")\n");
+    req_stamp(req, HOP_SERVER_ENTRY);
+    trace_begin("protected");
+    log_value(&log_out, "Received protected call, label", label);
 
     switch (label) {
     case 1:
-        microkit_dbg_puts("SERVER|INFO: Processing request type 1\n");
+        log_text(&log_out, "Processing request type 1");
         /* Echo back with label 10 */
-        return microkit_msginfo_new(10, 0);
+        reply = microkit_msginfo_new(10, 0);
+        break;
     
     case 2:
-        microkit_dbg_puts("SERVER|INFO: Processing request type 2\n");
+        log_text(&log_out, "Processing request type 2");
         /* Echo back with label 20 */
-        return microkit_msginfo_new(20, 0);
+        reply = microkit_msginfo_new(20, 0);
+        break;
     
     default:
         microkit_dbg_puts("SERVER|ERROR: Unknown message label\n");
-        return microkit_msginfo_new(0, 0);
+        reply = microkit_msginfo_new(0, 0);
+        break;
     }
+
+    trace_end("protected");
+    req_stamp(req, HOP_SERVER_EXIT);
+    /* The logger runs below the client, so this costs the call only the notify */
+    log_flush(&log_out);
+    return reply;
 }
 
 void init(void)
 {
-    microkit_dbg_puts("SERVER|INFO: Initializing server component\n");
-    microkit_dbg_puts("SERVER|INFO: Server ready to receive messages\n");
+    uint64_t boot_entry = boot_init_entry();
+
+    hwm_stack_paint(&stack);
+    /* The client cannot call in, and so cannot write it, before this returns */
+    hwm_paint(shared_buffer, SHARED_MEMORY_SIZE);
+
+    log_out.ring = (volatile struct log_ring *)log_ring_vaddr;
+    log_out.heads = (const volatile struct log_heads *)log_heads_vaddr;
+    rpc.q = (volatile struct rpc_queue *)rpc_queue_vaddr;
+    log_text(&log_out, "Initializing server component");
+    log_text(&log_out, "Server ready to receive messages");
+    log_flush(&log_out);
+
+    boot_init_exit("server", boot_entry);
 }
 
 void notified(microkit_channel ch)
 {
     if (ch == CLIENT_CH) {
-        microkit_dbg_puts("SERVER|INFO: Received notification from client\n");
-        microkit_dbg_puts("SERVER|INFO: Reading from shared memory: ");
+        uint64_t req = REQ->notify_req;
+
+        req_stamp(req, HOP_SERVER_ENTRY);
+        trace_begin("shared_mem");
+        log_text(&log_out, "Received notification from client");
+        log_text(&log_out, "Reading from shared memory:");
         
-        /* Read and print shared memory content */
-        for (int i = 0; i < SHARED_MEMORY_SIZE && SHARED_BUF[i] != '\0'; i++) {
-            microkit_dbg_putc(SHARED_BUF[i]);
-        }
-        microkit_dbg_puts("\n");
+        /* Log the shared memory content; the logger cannot read it itself */
+        log_text(&log_out, SHARED_BUF);
 
         /* Write response back to shared memory */
-        const char *response = "Server response via shared memory!";
-        for (int i = 0; response[i] != '\0' && i < SHARED_MEMORY_SIZE - 1; i++) {
-            SHARED_BUF[i] = response[i];
-        }
+        static const char response[] = "Server response via shared memory!";
+        memcpy(SHARED_BUF, response, sizeof(response));
         SHARED_BUF[SHARED_MEMORY_SIZE - 1] = '\0';
 
-        microkit_dbg_puts("SERVER|INFO: Wrote response to shared memory\n");
-        
-        /* Notify logger */
-        microkit_dbg_puts("SERVER|INFO: Notifying logger\n");
-        microkit_notify(LOGGER_CH);
+        log_text(&log_out, "Wrote response to shared memory");
+        trace_end("shared_mem");
+        req_stamp(req, HOP_SERVER_EXIT);
+
+        /* One notification for this batch */
+        log_flush(&log_out);
     } else if (ch == LOGGER_CH) {
-        microkit_dbg_puts("SERVER|INFO: Received notification from logger\n");
+        log_text(&log_out, "Received notification from logger");
+        log_flush(&log_out);
+    } else if (ch == LOADGEN_RPC_CH) {
+        serve_rpc();
     } else {
         microkit_dbg_puts("SERVER|WARN: Received notification on unexpected channel\n");
     }
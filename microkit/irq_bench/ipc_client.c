@@ -0,0 +1,33 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit IRQ Benchmark IPC Load
+ *
+ * Calls ipc_server back to back from the benchmark's notification until it
+ * starts another load, so the kernel is entered and left continuously
+ * while interrupts arrive.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "irq_bench.h"
+
+#define BENCH_CH 0
+#define SERVER_CH 1
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct irq_bench_control *)control_vaddr)
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != BENCH_CH) {
+        return;
+    }
+    while (CONTROL->active == LOAD_IPC_LOW) {
+        (void) microkit_ppcall(SERVER_CH, microkit_msginfo_new(0, 0));
+    }
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit IRQ Benchmark IPC Load Server
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+}
+
+seL4_MessageInfo_t protected(microkit_channel ch, microkit_msginfo msginfo)
+{
+    return microkit_msginfo_new(0, 0);
+}
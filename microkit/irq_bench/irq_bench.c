@@ -0,0 +1,207 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Interrupt Latency Benchmark
+ *
+ * Owns the EL1 physical timer (PPI 30) and uses it as a device whose
+ * interrupt time is known exactly: the line is raised when the counter
+ * reaches the compare value. Two measurements are taken:
+ *
+ *   latency     compare value to entry into notified(), with the timer
+ *               armed a pseudo-random 50-150 us ahead each time
+ *   turnaround  entry to entry with the timer re-armed already expired,
+ *               so the next interrupt is delivered as soon as the ack
+ *               lets it through: handler + ack + return to the kernel +
+ *               delivery again
+ *
+ * each with microkit_irq_ack() (its own system call) and with
+ * microkit_deferred_irq_ack() (folded into the receive the event loop
+ * does anyway), and each under four background loads started and stopped
+ * through the control page: none, a lower-priority spinner, a
+ * lower-priority IPC ping-pong, and a higher-priority spinner that MCS
+ * limits to half of each period.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+#include "stats.h"
+#include "irq_bench.h"
+
+#define IRQ_CH 0
+#define SPIN_LOW_CH 1
+#define IPC_CH 2
+#define SPIN_HIGH_CH 3
+
+#define CNTP_CTL_ENABLE (1 << 0)
+
+#define SAMPLES 2000
+#define MIN_DELAY_US 50
+#define MAX_DELAY_US 150
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct irq_bench_control *)control_vaddr)
+
+enum ack { ACK_IRQ, ACK_DEFERRED, NUM_ACKS };
+enum kind { KIND_LATENCY, KIND_TURNAROUND, NUM_KINDS };
+
+static const char *const load_names[] = { "none", "spin_low", "ipc_low", "spin_high" };
+static const microkit_channel load_channels[] = { 0, SPIN_LOW_CH, IPC_CH, SPIN_HIGH_CH };
+static const char *const ack_names[] = { "irq_ack", "deferred" };
+static const char *const kind_names[] = { "latency", "turnaround" };
+
+static unsigned phase;
+static unsigned count;
+static uint64_t armed_at;
+static uint64_t last_entry;
+static uint32_t samples[SAMPLES];
+
+static uint64_t freq;
+static uint64_t rng_state = 0x2545f4914f6cdd1dULL;
+
+static inline void arm_timer(uint64_t cval)
+{
+    __asm__ volatile("msr cntp_cval_el0, %0" : : "r" (cval));
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" ((uint64_t)CNTP_CTL_ENABLE));
+}
+
+static inline void disarm_timer(void)
+{
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" ((uint64_t)0));
+}
+
+static inline enum load phase_load(unsigned p)
+{
+    return p / (NUM_ACKS * NUM_KINDS);
+}
+
+static inline enum ack phase_ack(unsigned p)
+{
+    return (p / NUM_KINDS) % NUM_ACKS;
+}
+
+static inline enum kind phase_kind(unsigned p)
+{
+    return p % NUM_KINDS;
+}
+
+static void report(void)
+{
+    struct stats_summary s = stats_summarize_u32(samples, SAMPLES);
+
+    microkit_dbg_puts("IRQBENCH|METRIC: load=");
+    microkit_dbg_puts(load_names[phase_load(phase)]);
+    microkit_dbg_puts(" ack=");
+    microkit_dbg_puts(ack_names[phase_ack(phase)]);
+    microkit_dbg_puts(" kind=");
+    microkit_dbg_puts(kind_names[phase_kind(phase)]);
+    dbg_put_kv("samples", SAMPLES);
+    dbg_put_kv("min_ns", timing_ticks_to_ns(s.min));
+    dbg_put_kv("p50_ns", timing_ticks_to_ns(s.p50));
+    dbg_put_kv("p99_ns", timing_ticks_to_ns(s.p99));
+    dbg_put_kv("max_ns", timing_ticks_to_ns(s.max));
+    dbg_put_kv("avg_ns", timing_ticks_to_ns(s.avg));
+    microkit_dbg_puts("\n");
+}
+
+static void start_load(enum load load)
+{
+    if (load == LOAD_NONE) {
+        return;
+    }
+    CONTROL->active = load;
+    microkit_notify(load_channels[load]);
+}
+
+static void stop_load(void)
+{
+    /* The load PD sees this and returns to its event loop */
+    CONTROL->active = LOAD_NONE;
+}
+
+static void arm_next(void)
+{
+    if (phase_kind(phase) == KIND_TURNAROUND) {
+        /* Already expired: the line stays raised and fires again once acked */
+        arm_timer(0);
+        return;
+    }
+
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint64_t delay_us = MIN_DELAY_US + (rng_state >> 33) % (MAX_DELAY_US - MIN_DELAY_US + 1);
+    armed_at = timing_now() + delay_us * freq / 1000000;
+    arm_timer(armed_at);
+}
+
+/* Returns 0 once every phase has run */
+static int next_phase(void)
+{
+    enum load old_load = phase_load(phase);
+
+    phase++;
+    count = 0;
+    last_entry = 0;
+
+    if (phase == NUM_LOADS * NUM_ACKS * NUM_KINDS) {
+        stop_load();
+        return 0;
+    }
+    if (phase_load(phase) != old_load) {
+        stop_load();
+        start_load(phase_load(phase));
+    }
+    return 1;
+}
+
+static void handle_irq(void)
+{
+    uint64_t now = timing_now();
+
+    disarm_timer();
+
+    if (phase_kind(phase) == KIND_LATENCY) {
+        samples[count++] = now - armed_at;
+    } else if (last_entry != 0) {
+        samples[count++] = now - last_entry;
+    }
+    last_entry = now;
+
+    if (count == SAMPLES) {
+        report();
+        if (!next_phase()) {
+            microkit_dbg_puts("IRQBENCH|INFO: done\n");
+            microkit_irq_ack(IRQ_CH);
+            return;
+        }
+    }
+
+    arm_next();
+    if (phase_ack(phase) == ACK_DEFERRED) {
+        microkit_deferred_irq_ack(IRQ_CH);
+    } else {
+        microkit_irq_ack(IRQ_CH);
+    }
+}
+
+void init(void)
+{
+    freq = timing_freq();
+
+    microkit_dbg_puts("IRQBENCH|INFO: starting");
+    dbg_put_kv("freq_hz", freq);
+    microkit_dbg_puts("\n");
+
+    disarm_timer();
+    start_load(phase_load(0));
+    arm_next();
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch == IRQ_CH) {
+        handle_irq();
+    } else {
+        microkit_dbg_puts("IRQBENCH|ERROR: notification on unexpected channel\n");
+    }
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2025
+ * Control page shared between the IRQ benchmark and its load PDs
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+
+enum load {
+    LOAD_NONE,
+    /* Spinner below the benchmark's priority */
+    LOAD_SPIN_LOW,
+    /* IPC ping-pong below the benchmark's priority */
+    LOAD_IPC_LOW,
+    /* Spinner above the benchmark, limited by its MCS budget */
+    LOAD_SPIN_HIGH,
+    NUM_LOADS,
+};
+
+struct irq_bench_control {
+    /*
+     * Set before a load PD is notified; the load runs until it changes.
+     * A flag would not do: the low-priority loads never run between the
+     * benchmark clearing it for one phase and setting it for the next.
+     */
+    uint32_t active;
+};
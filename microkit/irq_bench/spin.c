@@ -0,0 +1,37 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit IRQ Benchmark CPU Load
+ *
+ * Spins from the benchmark's notification until another load is active.
+ * Built twice, as spin_low below the benchmark's priority and spin_high
+ * above it, where its MCS budget leaves the benchmark the rest of each
+ * period; SPIN_LOAD says which.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "irq_bench.h"
+
+#define BENCH_CH 0
+
+#ifndef SPIN_LOAD
+#error "SPIN_LOAD must be LOAD_SPIN_LOW or LOAD_SPIN_HIGH"
+#endif
+
+uintptr_t control_vaddr;
+#define CONTROL ((volatile struct irq_bench_control *)control_vaddr)
+
+void init(void)
+{
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != BENCH_CH) {
+        return;
+    }
+    while (CONTROL->active == SPIN_LOAD) {
+        __asm__ volatile("" ::: "memory");
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2025
+ * Block request/completion queues shared between a client PD and the
+ * virtio-blk driver
+ *
+ * One control region holds two single-producer/single-consumer rings
+ * with pkt_ring indices: requests (client produces, driver consumes) and
+ * responses (driver produces, client consumes). Data never goes through
+ * the rings; a request names an offset into a separate data region that
+ * both PDs map and the device DMAs to and from directly.
+ *
+ * The client notifies the driver after publishing a batch of requests;
+ * the driver notifies the client after publishing a batch of responses.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include "pkt_ring.h"
+
+/* Power of two, and no more than the driver can keep in flight */
+#define BLK_QUEUE_SIZE 64
+
+#define BLK_SECTOR_SIZE 512
+
+enum blk_op {
+    BLK_OP_READ = 0,
+    BLK_OP_WRITE = 1,
+    BLK_OP_FLUSH = 4,
+};
+
+enum blk_status {
+    BLK_STATUS_OK = 0,
+    BLK_STATUS_IOERR = 1,
+    BLK_STATUS_UNSUPPORTED = 2,
+    /* Rejected by the driver before reaching the device */
+    BLK_STATUS_INVALID = 3,
+};
+
+struct blk_request {
+    /* Returned unchanged in the response */
+    uint64_t id;
+    uint64_t sector;
+    /* Offset into the shared data region, and transfer size in bytes */
+    uint32_t data_offset;
+    uint32_t len;
+    uint32_t op;
+    uint32_t reserved;
+};
+
+struct blk_response {
+    uint64_t id;
+    uint32_t status;
+    uint32_t reserved;
+};
+
+struct blk_queue {
+    struct pkt_ring req_ring;
+    struct pkt_ring resp_ring;
+    /* Written once by the driver before it first notifies the client */
+    uint64_t capacity_sectors;
+    uint32_t ready;
+    uint32_t reserved;
+    struct blk_request req[BLK_QUEUE_SIZE];
+    struct blk_response resp[BLK_QUEUE_SIZE];
+};
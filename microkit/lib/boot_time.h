@@ -0,0 +1,40 @@
+/*
+ * Copyright 2025
+ * Boot-phase timestamps for PD init()
+ *
+ * A PD calls boot_init_entry() first thing in init() and passes the result
+ * to boot_init_exit() last thing, which prints
+ *
+ *   BOOT|METRIC: pd=<name> init_entry_ns=... init_exit_ns=... init_ns=...
+ *
+ * The counter (see timing.h) starts from zero when QEMU resets the
+ * machine, so the entry and exit stamps are times since reset: together
+ * with the loader, kernel and monitor lines that scripts/boot_timing.py
+ * timestamps on the host, they place each PD's init() in the boot. The
+ * print comes after the exit stamp and is not counted.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+
+static inline uint64_t boot_init_entry(void)
+{
+    return timing_now();
+}
+
+static inline void boot_init_exit(const char *pd, uint64_t entry)
+{
+    uint64_t exit = timing_now();
+
+    microkit_dbg_puts("BOOT|METRIC: pd=");
+    microkit_dbg_puts(pd);
+    dbg_put_kv("init_entry_ns", timing_ticks_to_ns(entry));
+    dbg_put_kv("init_exit_ns", timing_ticks_to_ns(exit));
+    dbg_put_kv("init_ns", timing_ticks_to_ns(exit - entry));
+    microkit_dbg_puts("\n");
+}
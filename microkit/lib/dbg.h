@@ -0,0 +1,48 @@
+/*
+ * Copyright 2025
+ * Number formatting helpers for the Microkit debug console
+ *
+ * libmicrokit only prints strings and 8/32-bit decimals; metrics need
+ * 64-bit values. Header-only so PDs pay only for what they use.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+
+static inline void dbg_put_u64(uint64_t val)
+{
+    char buf[21];
+    int pos = 20;
+    buf[pos] = '\0';
+    do {
+        buf[--pos] = '0' + (val % 10);
+        val /= 10;
+    } while (val > 0);
+    microkit_dbg_puts(&buf[pos]);
+}
+
+static inline void dbg_put_hex64(uint64_t val)
+{
+    char buf[19];
+    buf[0] = '0';
+    buf[1] = 'x';
+    for (int i = 17; i > 1; i--) {
+        unsigned int nibble = val & 0xf;
+        buf[i] = nibble < 10 ? '0' + nibble : 'a' + nibble - 10;
+        val >>= 4;
+    }
+    buf[18] = '\0';
+    microkit_dbg_puts(buf);
+}
+
+/* Emit " key=value" as used by the |METRIC lines the host scripts parse */
+static inline void dbg_put_kv(const char *key, uint64_t val)
+{
+    microkit_dbg_putc(' ');
+    microkit_dbg_puts(key);
+    microkit_dbg_putc('=');
+    dbg_put_u64(val);
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2025
+ * Client-side failover between a primary and a warm-standby server
+ *
+ * Two server PDs serve the same protocol from one shared state region, so
+ * either can answer any request. The client calls whichever one the
+ * status page names as active. A call to a server that faults mid-request
+ * never gets a reply, so recovering it takes the supervisor, which is the
+ * parent of both servers and of the client:
+ *
+ *   client      makes its calls with failover_ppcall(), which records in
+ *               the status page which server it is blocked on.
+ *   supervisor  in fault() for a server, makes the other one active and,
+ *               if the client is blocked on the faulted server, aborts
+ *               that call with failover_abort_call(). The client then
+ *               returns from the call with the FAILOVER_ABORTED label.
+ *
+ * failover_ppcall() reissues an aborted call to the now-active server with
+ * the same message, so the caller sees only a slower reply. A call can
+ * reach the new server after the old one had already applied it, so
+ * requests must be idempotent, e.g. by carrying a sequence number.
+ *
+ * The status page is shared by the client and the supervisor only.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+
+/* Reply label of an aborted call; servers must not use it */
+#define FAILOVER_ABORTED 0xfa11
+
+/* Longest message failover_ppcall() can reissue */
+#define FAILOVER_MAX_MRS 8
+
+struct failover_status {
+    /* Server the client calls: 0 primary, 1 standby. Written by the supervisor */
+    uint32_t active;
+    /* Server the client is blocked on plus one, 0 if none. Written by the client */
+    uint32_t calling;
+    /* Failovers so far. Written by the supervisor */
+    uint64_t failovers;
+    /* Counter values of the latest failover, for measurement */
+    uint64_t fault_time;
+    uint64_t handler_time;
+    uint64_t resume_time;
+};
+
+struct failover_client {
+    volatile struct failover_status *status;
+    /* Protected-call channels to the primary and the standby */
+    microkit_channel ch[2];
+    /* Calls reissued after an abort */
+    uint64_t reissued;
+};
+
+/*
+ * Protected call to the active server, reissued to the other one if the
+ * supervisor aborts it. Messages longer than FAILOVER_MAX_MRS are sent
+ * once and not reissued.
+ */
+static inline microkit_msginfo failover_ppcall(struct failover_client *c, microkit_msginfo msginfo)
+{
+    seL4_Word mrs[FAILOVER_MAX_MRS];
+    uint64_t count = microkit_msginfo_get_count(msginfo);
+    int reissuable = count <= FAILOVER_MAX_MRS;
+
+    if (reissuable) {
+        for (uint64_t i = 0; i < count; i++) {
+            mrs[i] = seL4_GetMR(i);
+        }
+    }
+
+    for (;;) {
+        uint32_t server = c->status->active;
+        c->status->calling = server + 1;
+        microkit_msginfo reply = microkit_ppcall(c->ch[server], msginfo);
+        c->status->calling = 0;
+
+        if (microkit_msginfo_get_label(reply) != FAILOVER_ABORTED || !reissuable) {
+            return reply;
+        }
+
+        /* The aborted call left whatever was in the registers as the reply */
+        c->reissued++;
+        for (uint64_t i = 0; i < count; i++) {
+            seL4_SetMR(i, mrs[i]);
+        }
+    }
+}
+
+/*
+ * From the supervisor: make a client blocked in a protected call return
+ * from it with the FAILOVER_ABORTED label. The kernel reports a thread
+ * blocked in a system call with its pc at the trapping svc/ecall, so the
+ * client is resumed one instruction on, where the call would have
+ * returned, with the label in the register that carries the reply's
+ * message info.
+ */
+static inline void failover_abort_call(microkit_child client)
+{
+    seL4_Error err;
+    seL4_UserContext ctxt;
+    seL4_Word count = sizeof(ctxt) / sizeof(seL4_Word);
+
+    err = seL4_TCB_ReadRegisters(BASE_TCB_CAP + client, seL4_False, 0, count, &ctxt);
+    if (err != seL4_NoError) {
+        microkit_dbg_puts("failover_abort_call: error reading TCB registers\n");
+        microkit_internal_crash(err);
+    }
+
+    ctxt.pc += 4;
+#if defined(__aarch64__)
+    ctxt.x1 = seL4_MessageInfo_new(FAILOVER_ABORTED, 0, 0, 0).words[0];
+#elif defined(__riscv)
+    ctxt.a1 = seL4_MessageInfo_new(FAILOVER_ABORTED, 0, 0, 0).words[0];
+#else
+#error "failover_abort_call: unsupported architecture"
+#endif
+
+    /* Resuming cancels the call and unbinds it from the server's reply object */
+    err = seL4_TCB_WriteRegisters(BASE_TCB_CAP + client, seL4_True, 0, count, &ctxt);
+    if (err != seL4_NoError) {
+        microkit_dbg_puts("failover_abort_call: error writing TCB registers\n");
+        microkit_internal_crash(err);
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2025
+ * High-water marks for PD stacks and memory regions
+ *
+ * Memory that nothing reports on is painted with a known pattern early
+ * on, and the peak use is read back later as the extent that no longer
+ * holds the pattern:
+ *
+ *   stacks   hwm_stack_paint() first thing in init() paints from the
+ *            bottom of the stack to just below the caller's frame;
+ *            hwm_stack_peak() then finds the deepest word written since.
+ *            Microkit maps the stack just below a page-aligned top, which
+ *            init() runs within a page of, and the SDF's stack_size sets
+ *            its size (4 KiB unless the PD overrides it; keep
+ *            HWM_STACK_SIZE in step).
+ *   regions  whichever PD initialises a shared region paints it before
+ *            anyone uses it; hwm_region_peak() returns the end of the
+ *            last word written and hwm_region_touched() how many bytes
+ *            were written at all, which differ when a PD writes, say,
+ *            only a terminator at the far end.
+ *
+ * A painted word that happens to be written with the pattern itself
+ * counts as unused, so the peak can read low by that word. Rings and
+ * buffers that keep their own counts report those instead (see
+ * log_ring.h's peak). hwm_report() prints
+ *
+ *   HWM|METRIC: pd=<name> region=<name> peak_bytes=... size_bytes=...
+ *
+ * and hwm_report_region() adds touched_bytes for a painted region.
+ * scripts/footprint.py --hwm sets these against the sizes in report.txt.
+ * Header-only.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+
+#ifndef HWM_STACK_SIZE
+#define HWM_STACK_SIZE 0x1000
+#endif
+
+#define HWM_PAINT 0xa5a5a5a5a5a5a5a5ULL
+#define HWM_PAGE_SIZE 0x1000
+/* Left unpainted below the caller's frame, for the painting loop itself */
+#define HWM_STACK_MARGIN 256
+
+struct hwm_stack {
+    uintptr_t bottom;
+    uintptr_t top;
+};
+
+static inline void hwm_paint(uintptr_t start, uintptr_t size)
+{
+    for (volatile uint64_t *p = (volatile uint64_t *)start; (uintptr_t)p < start + size; p++) {
+        *p = HWM_PAINT;
+    }
+}
+
+/* Bytes from start to the end of the last word no longer painted */
+static inline uintptr_t hwm_region_peak(uintptr_t start, uintptr_t size)
+{
+    const volatile uint64_t *p = (const volatile uint64_t *)(start + size);
+    while ((uintptr_t)p > start && p[-1] == HWM_PAINT) {
+        p--;
+    }
+    return (uintptr_t)p - start;
+}
+
+/* Bytes in words no longer painted, wherever they are */
+static inline uintptr_t hwm_region_touched(uintptr_t start, uintptr_t size)
+{
+    uintptr_t touched = 0;
+    for (const volatile uint64_t *p = (const volatile uint64_t *)start; (uintptr_t)p < start + size; p++) {
+        if (*p != HWM_PAINT) {
+            touched += sizeof(*p);
+        }
+    }
+    return touched;
+}
+
+/* Inlined so that the frame address is the caller's, i.e. init()'s */
+static inline __attribute__((always_inline)) void hwm_stack_paint(struct hwm_stack *s)
+{
+    uintptr_t frame = (uintptr_t)__builtin_frame_address(0);
+
+    s->top = (frame + HWM_PAGE_SIZE - 1) & ~(uintptr_t)(HWM_PAGE_SIZE - 1);
+    s->bottom = s->top - HWM_STACK_SIZE;
+    hwm_paint(s->bottom, (frame - HWM_STACK_MARGIN - s->bottom) & ~(uintptr_t)7);
+}
+
+/* Deepest use since hwm_stack_paint(), in bytes below the top */
+static inline uintptr_t hwm_stack_peak(const struct hwm_stack *s)
+{
+    const volatile uint64_t *p = (const volatile uint64_t *)s->bottom;
+    while ((uintptr_t)p < s->top && *p == HWM_PAINT) {
+        p++;
+    }
+    return s->top - (uintptr_t)p;
+}
+
+static inline void hwm_report(const char *pd, const char *region, uint64_t peak, uint64_t size)
+{
+    microkit_dbg_puts("HWM|METRIC: pd=");
+    microkit_dbg_puts(pd);
+    microkit_dbg_puts(" region=");
+    microkit_dbg_puts(region);
+    dbg_put_kv("peak_bytes", peak);
+    dbg_put_kv("size_bytes", size);
+    microkit_dbg_puts("\n");
+}
+
+static inline void hwm_report_region(const char *pd, const char *region, uintptr_t start, uintptr_t size)
+{
+    microkit_dbg_puts("HWM|METRIC: pd=");
+    microkit_dbg_puts(pd);
+    microkit_dbg_puts(" region=");
+    microkit_dbg_puts(region);
+    dbg_put_kv("peak_bytes", hwm_region_peak(start, size));
+    dbg_put_kv("touched_bytes", hwm_region_touched(start, size));
+    dbg_put_kv("size_bytes", size);
+    microkit_dbg_puts("\n");
+}
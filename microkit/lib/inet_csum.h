@@ -0,0 +1,59 @@
+/*
+ * Copyright 2025
+ * Internet (RFC 1071) checksum for Microkit protection domains
+ *
+ * Sums are kept as 32-bit partial values so a checksum can be built up
+ * over several buffers (e.g. a pseudo-header and a payload) and folded
+ * once at the end. Results are in the same byte order as the data, so
+ * they can be stored straight into a header field.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Add the ones'-complement sum of buf[0..len) to sum and return the new
+ * (unfolded) partial sum. buf may have any alignment.
+ */
+uint32_t csum_partial(const void *buf, size_t len, uint32_t sum);
+
+/* Fold a partial sum to 16 bits and complement it */
+static inline uint16_t csum_fold(uint32_t sum)
+{
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+/* Checksum of a single buffer, ready to store in a header */
+static inline uint16_t inet_csum(const void *buf, size_t len)
+{
+    return csum_fold(csum_partial(buf, len, 0));
+}
+
+/*
+ * Incremental update (RFC 1624, eqn. 3): HC' = ~(~HC + ~m + m').
+ * Use these when a forwarder rewrites a few header fields instead of
+ * summing the whole packet again. old/new are the field values as
+ * loaded from the packet, in the packet's byte order.
+ */
+static inline uint16_t csum_update16(uint16_t check, uint16_t old_val, uint16_t new_val)
+{
+    uint32_t sum = (uint16_t)~check;
+    sum += (uint16_t)~old_val;
+    sum += new_val;
+    return csum_fold(sum);
+}
+
+static inline uint16_t csum_update32(uint16_t check, uint32_t old_val, uint32_t new_val)
+{
+    uint32_t sum = (uint16_t)~check;
+    sum += (uint16_t)~old_val;
+    sum += (uint16_t)~(old_val >> 16);
+    sum += new_val & 0xffff;
+    sum += new_val >> 16;
+    return csum_fold(sum);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2025
+ * Open-addressing hash table for a key-value store PD
+ *
+ * Linear probing over an array of 32-byte slot headers, two to a cache
+ * line, that hold the key's hash, the key itself and the value's length.
+ * A lookup walks consecutive headers and compares the hash before the
+ * key, so it touches the values only on a hit. Values sit in a parallel
+ * array, one KV_VALUE_MAX-byte cell per slot.
+ *
+ * The table lives in a memory region of its own, which the PD maps
+ * read-write and no one else maps; a zeroed region is an empty table, so
+ * there is nothing to initialise. Deletes leave tombstones that later
+ * puts reuse. New keys are refused once KV_MAX_LOAD slots are in use,
+ * which keeps probe sequences short; the table is never resized.
+ *
+ * Header-only, like timeout_heap.h.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include "memops.h"
+
+#define KV_KEY_MAX 16
+
+#ifndef KV_VALUE_MAX
+#define KV_VALUE_MAX 1024
+#endif
+
+/* A power of two */
+#ifndef KV_SLOTS
+#define KV_SLOTS 512
+#endif
+
+#define KV_MAX_LOAD (KV_SLOTS / 4 * 3)
+
+enum kv_state {
+    KV_EMPTY = 0,
+    KV_USED,
+    KV_DELETED,
+};
+
+enum kv_status {
+    KV_OK = 0,
+    KV_NOT_FOUND,
+    KV_FULL,
+    KV_TOO_BIG,
+    /* Not an operation the server knows */
+    KV_INVALID,
+};
+
+struct kv_meta {
+    uint32_t hash;
+    uint16_t val_len;
+    uint8_t key_len;
+    uint8_t state;
+    uint8_t key[KV_KEY_MAX];
+    uint64_t reserved;
+};
+
+struct kv_table {
+    /* Slots in state KV_USED */
+    uint64_t count;
+    uint8_t pad[64 - sizeof(uint64_t)];
+    struct kv_meta meta[KV_SLOTS];
+    uint8_t value[KV_SLOTS][KV_VALUE_MAX];
+};
+
+_Static_assert(sizeof(struct kv_meta) == 32, "kv_meta must pack two to a cache line");
+_Static_assert((KV_SLOTS & (KV_SLOTS - 1)) == 0, "KV_SLOTS must be a power of two");
+
+/* FNV-1a */
+static inline uint32_t kv_hash(const uint8_t *key, unsigned len)
+{
+    uint32_t h = 2166136261u;
+    for (unsigned i = 0; i < len; i++) {
+        h = (h ^ key[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* Slot holding key, or -1 */
+static inline int kv_find(const struct kv_table *t, const uint8_t *key, unsigned len, uint32_t hash)
+{
+    unsigned i = hash & (KV_SLOTS - 1);
+    for (unsigned probes = 0; probes < KV_SLOTS; probes++, i = (i + 1) & (KV_SLOTS - 1)) {
+        const struct kv_meta *m = &t->meta[i];
+        if (m->state == KV_EMPTY) {
+            return -1;
+        }
+        if (m->state == KV_USED && m->hash == hash && m->key_len == len && memcmp(m->key, key, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* The value stored under key and its length, or NULL */
+static inline const uint8_t *kv_get(const struct kv_table *t, const uint8_t *key, unsigned len,
+                                    unsigned *val_len)
+{
+    int slot = kv_find(t, key, len, kv_hash(key, len));
+    if (slot < 0) {
+        return 0;
+    }
+    *val_len = t->meta[slot].val_len;
+    return t->value[slot];
+}
+
+static inline enum kv_status kv_put(struct kv_table *t, const uint8_t *key, unsigned len,
+                                    const void *val, unsigned val_len)
+{
+    if (len > KV_KEY_MAX || val_len > KV_VALUE_MAX) {
+        return KV_TOO_BIG;
+    }
+
+    uint32_t hash = kv_hash(key, len);
+    int slot = kv_find(t, key, len, hash);
+    if (slot < 0) {
+        if (t->count >= KV_MAX_LOAD) {
+            return KV_FULL;
+        }
+        /* First free slot on the probe sequence, tombstone or empty */
+        unsigned i = hash & (KV_SLOTS - 1);
+        while (t->meta[i].state == KV_USED) {
+            i = (i + 1) & (KV_SLOTS - 1);
+        }
+        slot = i;
+        struct kv_meta *m = &t->meta[slot];
+        m->hash = hash;
+        m->key_len = len;
+        memcpy(m->key, key, len);
+        m->state = KV_USED;
+        t->count++;
+    }
+
+    memcpy(t->value[slot], val, val_len);
+    t->meta[slot].val_len = val_len;
+    return KV_OK;
+}
+
+static inline enum kv_status kv_delete(struct kv_table *t, const uint8_t *key, unsigned len)
+{
+    int slot = kv_find(t, key, len, kv_hash(key, len));
+    if (slot < 0) {
+        return KV_NOT_FOUND;
+    }
+    t->meta[slot].state = KV_DELETED;
+    t->count--;
+    return KV_OK;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2025
+ * Per-producer log rings drained by a logger PD
+ *
+ * Each producer owns one ring in its own region, mapped read-write into
+ * the producer and read-only into the logger. The producer appends fixed
+ * size records (a timestamp, a short text and an optional value) and
+ * publishes each one by storing tail; log_flush() then sends the logger
+ * a single notification for everything written since the last flush.
+ * The logger hands slots back through a heads page that only it can
+ * write, one head per producer, so neither side writes anything the
+ * other owns and the logger never sees a producer's own memory.
+ *
+ * The logger drains every ring on each wakeup and prints the records in
+ * timestamp order. A full ring drops the new record and counts it; the
+ * logger reports the count. The logger reads at most a ring's worth of
+ * records and LOG_TEXT_LEN bytes of each text, whatever the producer
+ * wrote. The producer also keeps the most records the
+ * ring has held at once, for sizing it.
+ *
+ * Indices are free-running 64-bit counts, so the slot count need not be
+ * a power of two. Header-only, like pkt_ring.h.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+#include "timing.h"
+
+/* Size of each producer's ring region */
+#define LOG_RING_SIZE 0x1000
+#define LOG_CACHELINE 64
+#define LOG_TEXT_LEN 44
+#define LOG_MAX_PRODUCERS 8
+
+#define LOG_RECORD_VALUE (1 << 0)
+
+struct log_record {
+    /* Counter value when the record was written */
+    uint64_t timestamp;
+    /* Printed after the text as "=value" if LOG_RECORD_VALUE is set */
+    uint64_t value;
+    uint32_t flags;
+    /* NUL-terminated, truncated to fit */
+    char text[LOG_TEXT_LEN];
+};
+
+struct log_ring {
+    /* Producer-owned: records before tail are written */
+    uint64_t tail;
+    /* Producer-owned: records dropped because the ring was full */
+    uint64_t dropped;
+    /* Producer-owned: most records written and not yet handed back */
+    uint64_t peak;
+    uint8_t pad[LOG_CACHELINE - 3 * sizeof(uint64_t)];
+    struct log_record records[];
+};
+
+#define LOG_RING_SLOTS ((LOG_RING_SIZE - sizeof(struct log_ring)) / sizeof(struct log_record))
+
+/* Logger-owned: records before head[i] of producer i have been printed */
+struct log_heads {
+    struct {
+        uint64_t head;
+        uint8_t pad[LOG_CACHELINE - sizeof(uint64_t)];
+    } producer[LOG_MAX_PRODUCERS];
+};
+
+_Static_assert(sizeof(struct log_record) == LOG_CACHELINE, "log_record must fill one cache line");
+
+/* Producer side */
+
+struct log_producer {
+    volatile struct log_ring *ring;
+    const volatile struct log_heads *heads;
+    /* Index of this producer in the heads page */
+    unsigned id;
+    /* Notification channel to the logger */
+    microkit_channel ch;
+    /* Records written since the last flush */
+    unsigned pending;
+};
+
+static inline void log_write(struct log_producer *p, const char *text, uint32_t flags, uint64_t value)
+{
+    uint64_t tail = p->ring->tail;
+    uint64_t head = __atomic_load_n(&p->heads->producer[p->id].head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= LOG_RING_SLOTS) {
+        p->ring->dropped++;
+        return;
+    }
+
+    volatile struct log_record *r = &p->ring->records[tail % LOG_RING_SLOTS];
+    unsigned i = 0;
+    for (; i < LOG_TEXT_LEN - 1 && text[i] != '\0'; i++) {
+        r->text[i] = text[i];
+    }
+    r->text[i] = '\0';
+    r->flags = flags;
+    r->value = value;
+    r->timestamp = timing_now();
+
+    __atomic_store_n(&p->ring->tail, tail + 1, __ATOMIC_RELEASE);
+    p->pending++;
+    if (tail + 1 - head > p->ring->peak) {
+        p->ring->peak = tail + 1 - head;
+    }
+}
+
+static inline void log_text(struct log_producer *p, const char *text)
+{
+    log_write(p, text, 0, 0);
+}
+
+static inline void log_value(struct log_producer *p, const char *text, uint64_t value)
+{
+    log_write(p, text, LOG_RECORD_VALUE, value);
+}
+
+/* One notification for the whole batch written since the last flush */
+static inline void log_flush(struct log_producer *p)
+{
+    if (p->pending != 0) {
+        p->pending = 0;
+        microkit_notify(p->ch);
+    }
+}
+
+/* Logger side */
+
+struct log_source {
+    const volatile struct log_ring *ring;
+    /* Name printed with each record */
+    const char *name;
+    /* Local copy of this producer's head */
+    uint64_t head;
+    /* ring->dropped as of the last report */
+    uint64_t dropped_seen;
+    /* Records skipped because tail was not within a ring of head; the caller reports and clears it */
+    uint64_t skipped;
+};
+
+typedef void (*log_print_fn)(const struct log_source *src, const volatile struct log_record *r);
+
+/*
+ * Print every record written so far, oldest timestamp first across all
+ * producers, then hand the slots back. srcs[i] is the producer with id i.
+ * Records written while this runs are left for the next wakeup. A tail
+ * more than LOG_RING_SLOTS ahead of head, or behind it, is not trusted:
+ * head skips to it and the records in between count in skipped. Returns
+ * the number printed.
+ */
+static inline unsigned log_drain(struct log_source *srcs, unsigned n, volatile struct log_heads *heads,
+                                 log_print_fn print)
+{
+    uint64_t tails[LOG_MAX_PRODUCERS];
+    unsigned printed = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        tails[i] = __atomic_load_n(&srcs[i].ring->tail, __ATOMIC_ACQUIRE);
+        /* The producer owns tail and may have scribbled on it: resync rather than read past the ring */
+        if (tails[i] - srcs[i].head > LOG_RING_SLOTS) {
+            if (tails[i] > srcs[i].head) {
+                srcs[i].skipped += tails[i] - srcs[i].head;
+            }
+            srcs[i].head = tails[i];
+        }
+    }
+
+    for (;;) {
+        int next = -1;
+        uint64_t earliest = UINT64_MAX;
+
+        for (unsigned i = 0; i < n; i++) {
+            if (srcs[i].head == tails[i]) {
+                continue;
+            }
+            uint64_t t = srcs[i].ring->records[srcs[i].head % LOG_RING_SLOTS].timestamp;
+            if (next < 0 || t < earliest) {
+                next = i;
+                earliest = t;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        print(&srcs[next], &srcs[next].ring->records[srcs[next].head % LOG_RING_SLOTS]);
+        srcs[next].head++;
+        printed++;
+    }
+
+    for (unsigned i = 0; i < n; i++) {
+        __atomic_store_n(&heads->producer[i].head, srcs[i].head, __ATOMIC_RELEASE);
+    }
+    return printed;
+}
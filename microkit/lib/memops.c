@@ -0,0 +1,337 @@
+/*
+ * Copyright 2025
+ * Freestanding memory operations for Microkit protection domains
+ *
+ * See memops.h for the contract. Sizes are dispatched into:
+ *   - tiny   (< 16 bytes): two overlapping 8-byte ops, or a byte loop
+ *   - small  (16..64):     two or four overlapping 16-byte ops
+ *   - large  (> 64):       align the destination to 16 bytes, stream
+ *                          64-byte blocks, finish with one overlapping block
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#define MEMOPS_IMPLEMENTATION
+#include <stdint.h>
+#include "memops.h"
+
+/*
+ * The fallback loops below look exactly like memcpy/memset to GCC's loop
+ * distribution pass, which would turn them back into calls to ourselves.
+ */
+#pragma GCC optimize ("no-tree-loop-distribute-patterns")
+
+#if defined(__aarch64__) && !defined(MEMOPS_NO_SIMD)
+#define MEMOPS_SIMD 1
+#include <arm_neon.h>
+#endif
+
+static inline void copy_bytes(uint8_t *d, const uint8_t *s, size_t n)
+{
+    while (n--) {
+        *d++ = *s++;
+    }
+}
+
+static inline void set_bytes(uint8_t *d, uint8_t c, size_t n)
+{
+    while (n--) {
+        *d++ = c;
+    }
+}
+
+static inline int cmp_bytes(const uint8_t *p, const uint8_t *q, size_t n)
+{
+    for (; n; n--, p++, q++) {
+        if (*p != *q) {
+            return (int)*p - (int)*q;
+        }
+    }
+    return 0;
+}
+
+#ifdef MEMOPS_SIMD
+
+/*
+ * LD1/ST1 with byte elements only require byte alignment, even when the
+ * kernel has alignment checking enabled, so these are safe on any pointer.
+ * Plain vector loads (LDR Q) would not be under -mstrict-align, which is
+ * why the intrinsics' own load/store lowering is not used here.
+ */
+typedef struct { uint8_t b[8]; } blk8_t;
+typedef struct { uint8_t b[16]; } blk16_t;
+
+static inline uint8x8_t ld8(const uint8_t *s)
+{
+    uint8x8_t v;
+    asm("ld1 {%0.8b}, [%1]" : "=w"(v) : "r"(s), "m"(*(const blk8_t *)s));
+    return v;
+}
+
+static inline void st8(uint8_t *d, uint8x8_t v)
+{
+    asm("st1 {%1.8b}, [%2]" : "=m"(*(blk8_t *)d) : "w"(v), "r"(d));
+}
+
+static inline uint8x16_t ld16(const uint8_t *s)
+{
+    uint8x16_t v;
+    asm("ld1 {%0.16b}, [%1]" : "=w"(v) : "r"(s), "m"(*(const blk16_t *)s));
+    return v;
+}
+
+static inline void st16(uint8_t *d, uint8x16_t v)
+{
+    asm("st1 {%1.16b}, [%2]" : "=m"(*(blk16_t *)d) : "w"(v), "r"(d));
+}
+
+static inline void copy64(uint8_t *d, const uint8_t *s)
+{
+    uint8x16_t a = ld16(s);
+    uint8x16_t b = ld16(s + 16);
+    uint8x16_t c = ld16(s + 32);
+    uint8x16_t e = ld16(s + 48);
+    st16(d, a);
+    st16(d + 16, b);
+    st16(d + 32, c);
+    st16(d + 48, e);
+}
+
+void *memcpy(void *restrict dst, const void *restrict src, size_t n)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    if (n < 16) {
+        if (n >= 8) {
+            uint8x8_t a = ld8(s);
+            uint8x8_t b = ld8(s + n - 8);
+            st8(d, a);
+            st8(d + n - 8, b);
+        } else {
+            copy_bytes(d, s, n);
+        }
+        return dst;
+    }
+
+    if (n <= 32) {
+        uint8x16_t a = ld16(s);
+        uint8x16_t b = ld16(s + n - 16);
+        st16(d, a);
+        st16(d + n - 16, b);
+        return dst;
+    }
+
+    if (n <= 64) {
+        uint8x16_t a = ld16(s);
+        uint8x16_t b = ld16(s + 16);
+        uint8x16_t c = ld16(s + n - 32);
+        uint8x16_t e = ld16(s + n - 16);
+        st16(d, a);
+        st16(d + 16, b);
+        st16(d + n - 32, c);
+        st16(d + n - 16, e);
+        return dst;
+    }
+
+    /* Copy the first block unaligned, then skew so the stores are aligned */
+    size_t skew = 16 - ((uintptr_t)d & 15);
+    st16(d, ld16(s));
+    d += skew;
+    s += skew;
+    n -= skew;
+
+    while (n > 64) {
+        copy64(d, s);
+        d += 64;
+        s += 64;
+        n -= 64;
+    }
+
+    /* 1..64 bytes left: the original length was > 64, so back up and redo a full block */
+    copy64(d + n - 64, s + n - 64);
+    return dst;
+}
+
+void *memset(void *dst, int c, size_t n)
+{
+    uint8_t *d = dst;
+
+    if (n < 16) {
+        if (n >= 8) {
+            uint8x8_t v = vdup_n_u8((uint8_t)c);
+            st8(d, v);
+            st8(d + n - 8, v);
+        } else {
+            set_bytes(d, (uint8_t)c, n);
+        }
+        return dst;
+    }
+
+    uint8x16_t v = vdupq_n_u8((uint8_t)c);
+
+    if (n <= 32) {
+        st16(d, v);
+        st16(d + n - 16, v);
+        return dst;
+    }
+
+    if (n <= 64) {
+        st16(d, v);
+        st16(d + 16, v);
+        st16(d + n - 32, v);
+        st16(d + n - 16, v);
+        return dst;
+    }
+
+    size_t skew = 16 - ((uintptr_t)d & 15);
+    st16(d, v);
+    d += skew;
+    n -= skew;
+
+    while (n > 64) {
+        st16(d, v);
+        st16(d + 16, v);
+        st16(d + 32, v);
+        st16(d + 48, v);
+        d += 64;
+        n -= 64;
+    }
+
+    st16(d + n - 64, v);
+    st16(d + n - 48, v);
+    st16(d + n - 32, v);
+    st16(d + n - 16, v);
+    return dst;
+}
+
+int memcmp(const void *a, const void *b, size_t n)
+{
+    const uint8_t *p = a;
+    const uint8_t *q = b;
+
+    /* Only find out whether a block differs; the byte loop locates where */
+    while (n >= 64) {
+        uint8x16_t x0 = veorq_u8(ld16(p), ld16(q));
+        uint8x16_t x1 = veorq_u8(ld16(p + 16), ld16(q + 16));
+        uint8x16_t x2 = veorq_u8(ld16(p + 32), ld16(q + 32));
+        uint8x16_t x3 = veorq_u8(ld16(p + 48), ld16(q + 48));
+        if (vmaxvq_u8(vorrq_u8(vorrq_u8(x0, x1), vorrq_u8(x2, x3))) != 0) {
+            return cmp_bytes(p, q, 64);
+        }
+        p += 64;
+        q += 64;
+        n -= 64;
+    }
+
+    while (n >= 16) {
+        if (vmaxvq_u8(veorq_u8(ld16(p), ld16(q))) != 0) {
+            return cmp_bytes(p, q, 16);
+        }
+        p += 16;
+        q += 16;
+        n -= 16;
+    }
+
+    return cmp_bytes(p, q, n);
+}
+
+#else /* !MEMOPS_SIMD */
+
+/*
+ * Generic path: word-at-a-time once both pointers can be brought to the
+ * same 8-byte alignment, bytes otherwise. Never issues an unaligned access.
+ */
+#define WORD_MASK (sizeof(uint64_t) - 1)
+
+void *memcpy(void *restrict dst, const void *restrict src, size_t n)
+{
+    uint8_t *d = dst;
+    const uint8_t *s = src;
+
+    if ((((uintptr_t)d ^ (uintptr_t)s) & WORD_MASK) == 0) {
+        while (n && ((uintptr_t)d & WORD_MASK)) {
+            *d++ = *s++;
+            n--;
+        }
+
+        uint64_t *dw = (uint64_t *)d;
+        const uint64_t *sw = (const uint64_t *)s;
+        while (n >= 32) {
+            dw[0] = sw[0];
+            dw[1] = sw[1];
+            dw[2] = sw[2];
+            dw[3] = sw[3];
+            dw += 4;
+            sw += 4;
+            n -= 32;
+        }
+        while (n >= 8) {
+            *dw++ = *sw++;
+            n -= 8;
+        }
+        d = (uint8_t *)dw;
+        s = (const uint8_t *)sw;
+    }
+
+    copy_bytes(d, s, n);
+    return dst;
+}
+
+void *memset(void *dst, int c, size_t n)
+{
+    uint8_t *d = dst;
+    uint64_t pattern = 0x0101010101010101ULL * (uint8_t)c;
+
+    while (n && ((uintptr_t)d & WORD_MASK)) {
+        *d++ = (uint8_t)c;
+        n--;
+    }
+
+    uint64_t *dw = (uint64_t *)d;
+    while (n >= 32) {
+        dw[0] = pattern;
+        dw[1] = pattern;
+        dw[2] = pattern;
+        dw[3] = pattern;
+        dw += 4;
+        n -= 32;
+    }
+    while (n >= 8) {
+        *dw++ = pattern;
+        n -= 8;
+    }
+
+    set_bytes((uint8_t *)dw, (uint8_t)c, n);
+    return dst;
+}
+
+int memcmp(const void *a, const void *b, size_t n)
+{
+    const uint8_t *p = a;
+    const uint8_t *q = b;
+
+    if ((((uintptr_t)p ^ (uintptr_t)q) & WORD_MASK) == 0) {
+        while (n && ((uintptr_t)p & WORD_MASK)) {
+            if (*p != *q) {
+                return (int)*p - (int)*q;
+            }
+            p++;
+            q++;
+            n--;
+        }
+
+        const uint64_t *pw = (const uint64_t *)p;
+        const uint64_t *qw = (const uint64_t *)q;
+        while (n >= 8 && *pw == *qw) {
+            pw++;
+            qw++;
+            n -= 8;
+        }
+        p = (const uint8_t *)pw;
+        q = (const uint8_t *)qw;
+    }
+
+    return cmp_bytes(p, q, n);
+}
+
+#endif /* MEMOPS_SIMD */
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2025
+ * Freestanding memory operations for Microkit protection domains
+ *
+ * PDs are built with -nostdlib -ffreestanding, so there is no libc to
+ * provide memcpy/memset/memcmp. memops.c provides them with a
+ * size-dispatched Advanced SIMD path on AArch64 and a word-at-a-time
+ * generic path elsewhere (or when built with -DMEMOPS_NO_SIMD).
+ *
+ * All routines are safe under -mstrict-align: the SIMD path only uses
+ * byte-element loads/stores and the generic path only issues word
+ * accesses once both pointers are naturally aligned. They are intended
+ * for normal (cached) memory such as shared regions and packet buffers,
+ * not for device registers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stddef.h>
+
+void *memcpy(void *restrict dst, const void *restrict src, size_t n);
+void *memset(void *dst, int c, size_t n);
+int memcmp(const void *a, const void *b, size_t n);
+
+/*
+ * -ffreestanding implies -fno-builtin, which stops the compiler from
+ * expanding small constant-size copies inline. Route call sites through
+ * the builtins so those still get expanded; everything else ends up in
+ * the out-of-line versions above.
+ */
+#ifndef MEMOPS_IMPLEMENTATION
+#define memcpy(d, s, n) __builtin_memcpy((d), (s), (n))
+#define memset(d, c, n) __builtin_memset((d), (c), (n))
+#define memcmp(a, b, n) __builtin_memcmp((a), (b), (n))
+#endif
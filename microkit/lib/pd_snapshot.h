@@ -0,0 +1,196 @@
+/*
+ * Copyright 2025
+ * Clean restart of a child PD from a snapshot of its writable segment
+ *
+ * microkit_pd_restart() only moves a child's pc back to _start. Its .data
+ * and .bss keep whatever they held when it faulted, and so does its stack
+ * pointer, so each restart also runs on a deeper stack than the last.
+ * A clean restart is split between the two sides:
+ *
+ *   child   calls pd_snapshot_init() first thing in init(). On the first
+ *           boot it sends its writable segment to the parent over a
+ *           protected procedure call, a chunk per call; on every later
+ *           boot it copies back only the pages that no longer match, so a
+ *           restart costs one compare of the segment plus one copy per
+ *           dirtied page.
+ *   parent  owns the snapshot region and writes it, from
+ *           pd_snapshot_protected() in its protected(). It accepts the
+ *           segment once and never again, so a child that has gone wrong
+ *           cannot damage the state it is restored to. It restarts the
+ *           child with pd_snapshot_restart(), which resets the stack
+ *           pointer as well as the pc.
+ *
+ * The child maps the region read-only. Microkit cannot map a child's ELF
+ * frames into its parent, and the Microkit tool patches setvars into them
+ * after the ELF is linked, so the segment has to come from the running
+ * child; for the same reason the copy back is the child's own, done
+ * before anything else in init() touches its state (only main()'s
+ * init_array walk runs earlier). Needs memops.o.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <microkit.h>
+#include "memops.h"
+
+#define PD_SNAPSHOT_PAGE_SIZE 0x1000
+
+/* microkit.ld links every PD's _start here */
+#define PD_ENTRY_POINT 0x200000
+
+/* The Microkit tool maps every PD's stack to end here */
+#if defined(__aarch64__)
+#define PD_STACK_TOP 0x10000000000ULL
+#elif defined(__riscv)
+#define PD_STACK_TOP 0x3ffffff000ULL
+#else
+#error "pd_snapshot: unsupported architecture"
+#endif
+
+/* Words per protected call while sending the segment */
+#define PD_SNAPSHOT_CHUNK_WORDS 64
+#define PD_SNAPSHOT_CHUNK_SIZE (PD_SNAPSHOT_CHUNK_WORDS * sizeof(seL4_Word))
+
+/* Labels of the child's calls: a chunk carries its index in MR0, then the words */
+#define PD_SNAPSHOT_LABEL_CHUNK 1
+/* MR0 is the segment size in pages; the snapshot is complete */
+#define PD_SNAPSHOT_LABEL_DONE 2
+
+/* Labels of the parent's replies */
+#define PD_SNAPSHOT_OK 0
+#define PD_SNAPSHOT_REFUSED 1
+
+/* First page of the snapshot region; the copy starts on the next page */
+struct pd_snapshot_header {
+    /* Set by the parent once the copy is complete */
+    uint64_t valid;
+    /* Pages in the writable segment */
+    uint64_t pages;
+};
+
+/* Bounds of the writable segment, from microkit.ld */
+extern char __init_array_start[];
+extern char _bss_end[];
+
+/*
+ * Parent: handle one call from the child on its snapshot channel. Chunks
+ * must fall inside the region, and nothing is accepted once the snapshot
+ * is complete.
+ */
+static inline microkit_msginfo pd_snapshot_protected(uintptr_t region, uint64_t region_size,
+                                                     microkit_msginfo msginfo)
+{
+    volatile struct pd_snapshot_header *hdr = (volatile struct pd_snapshot_header *)region;
+    uint64_t space = region_size - PD_SNAPSHOT_PAGE_SIZE;
+
+    if (hdr->valid) {
+        return microkit_msginfo_new(PD_SNAPSHOT_REFUSED, 0);
+    }
+
+    switch (microkit_msginfo_get_label(msginfo)) {
+    case PD_SNAPSHOT_LABEL_CHUNK: {
+        uint64_t chunk = microkit_mr_get(0);
+        uint64_t words = microkit_msginfo_get_count(msginfo) - 1;
+        if (words > PD_SNAPSHOT_CHUNK_WORDS || chunk >= space / PD_SNAPSHOT_CHUNK_SIZE) {
+            return microkit_msginfo_new(PD_SNAPSHOT_REFUSED, 0);
+        }
+        volatile seL4_Word *dst = (volatile seL4_Word *)(region + PD_SNAPSHOT_PAGE_SIZE
+                                                         + chunk * PD_SNAPSHOT_CHUNK_SIZE);
+        for (uint64_t i = 0; i < words; i++) {
+            dst[i] = microkit_mr_get(i + 1);
+        }
+        return microkit_msginfo_new(PD_SNAPSHOT_OK, 0);
+    }
+    case PD_SNAPSHOT_LABEL_DONE: {
+        uint64_t pages = microkit_mr_get(0);
+        if (pages > space / PD_SNAPSHOT_PAGE_SIZE) {
+            return microkit_msginfo_new(PD_SNAPSHOT_REFUSED, 0);
+        }
+        hdr->pages = pages;
+        __asm__ volatile("" ::: "memory");
+        hdr->valid = 1;
+        return microkit_msginfo_new(PD_SNAPSHOT_OK, 0);
+    }
+    default:
+        return microkit_msginfo_new(PD_SNAPSHOT_REFUSED, 0);
+    }
+}
+
+/*
+ * Child: send the snapshot to the parent over ch on the first boot, restore
+ * from it on later ones. Returns the number of pages copied back (0 on the
+ * first boot), or -1 if the parent refused the segment, in which case
+ * nothing is restored.
+ */
+static inline int pd_snapshot_init(microkit_channel ch, uintptr_t region)
+{
+    const volatile struct pd_snapshot_header *hdr = (const volatile struct pd_snapshot_header *)region;
+    uintptr_t snap = region + PD_SNAPSHOT_PAGE_SIZE;
+    uintptr_t start = (uintptr_t)__init_array_start & ~(uintptr_t)(PD_SNAPSHOT_PAGE_SIZE - 1);
+    uintptr_t end = (uintptr_t)_bss_end;
+    uint64_t pages = (end - start + PD_SNAPSHOT_PAGE_SIZE - 1) / PD_SNAPSHOT_PAGE_SIZE;
+    int restored = 0;
+
+    /* Hide where start came from: the copies below rewrite every global */
+    __asm__ volatile("" : "+r" (start));
+
+    if (!hdr->valid) {
+        uint64_t chunks = pages * PD_SNAPSHOT_PAGE_SIZE / PD_SNAPSHOT_CHUNK_SIZE;
+        for (uint64_t c = 0; c < chunks; c++) {
+            const seL4_Word *src = (const seL4_Word *)(start + c * PD_SNAPSHOT_CHUNK_SIZE);
+            microkit_mr_set(0, c);
+            for (unsigned i = 0; i < PD_SNAPSHOT_CHUNK_WORDS; i++) {
+                microkit_mr_set(i + 1, src[i]);
+            }
+            microkit_msginfo reply = microkit_ppcall(ch, microkit_msginfo_new(PD_SNAPSHOT_LABEL_CHUNK,
+                                                                             PD_SNAPSHOT_CHUNK_WORDS + 1));
+            if (microkit_msginfo_get_label(reply) != PD_SNAPSHOT_OK) {
+                return -1;
+            }
+        }
+        microkit_mr_set(0, pages);
+        microkit_msginfo reply = microkit_ppcall(ch, microkit_msginfo_new(PD_SNAPSHOT_LABEL_DONE, 1));
+        return microkit_msginfo_get_label(reply) == PD_SNAPSHOT_OK ? 0 : -1;
+    }
+
+    if (hdr->pages != pages) {
+        return -1;
+    }
+
+    for (uint64_t i = 0; i < pages; i++) {
+        void *page = (void *)(start + i * PD_SNAPSHOT_PAGE_SIZE);
+        const void *saved = (const void *)(snap + i * PD_SNAPSHOT_PAGE_SIZE);
+        if (memcmp(page, saved, PD_SNAPSHOT_PAGE_SIZE) != 0) {
+            memcpy(page, saved, PD_SNAPSHOT_PAGE_SIZE);
+            restored++;
+        }
+    }
+    __asm__ volatile("" ::: "memory");
+
+    return restored;
+}
+
+/* Restart a child at _start on a fresh stack; call from the parent's fault() */
+static inline void pd_snapshot_restart(microkit_child child)
+{
+    seL4_Error err;
+    seL4_UserContext ctxt = {0};
+    ctxt.pc = PD_ENTRY_POINT;
+    ctxt.sp = PD_STACK_TOP;
+    err = seL4_TCB_WriteRegisters(
+              BASE_TCB_CAP + child,
+              seL4_True,
+              0, /* No flags */
+              /* Up to and including sp (pc, sp on AArch64; pc, ra, sp on RISC-V) */
+              offsetof(seL4_UserContext, sp) / sizeof(seL4_Word) + 1,
+              &ctxt
+          );
+
+    if (err != seL4_NoError) {
+        microkit_dbg_puts("pd_snapshot_restart: error writing TCB registers\n");
+        microkit_internal_crash(err);
+    }
+}
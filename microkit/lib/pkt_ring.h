@@ -0,0 +1,58 @@
+/*
+ * Copyright 2025
+ * Single-producer/single-consumer packet ring shared between PDs
+ *
+ * Packets live in a data region of fixed-size slots; this control block
+ * lives in its own small region and only carries two free-running
+ * indices. The producer fills slots from tail and publishes a whole
+ * batch by storing tail once; the consumer drains [head, tail) and hands
+ * the slots back by storing head once. Neither side ever writes the
+ * other's index, so there is no per-slot flag to poll or clear.
+ *
+ * The slot count must be a power of two so free-running indices wrap
+ * cleanly. Header-only: there is nothing here worth a call.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define PKT_RING_CACHELINE 64
+
+struct pkt_ring {
+    /* Producer-owned: slots before tail hold packets */
+    uint32_t tail;
+    uint8_t pad0[PKT_RING_CACHELINE - sizeof(uint32_t)];
+    /* Consumer-owned: slots before head are free again */
+    uint32_t head;
+    uint8_t pad1[PKT_RING_CACHELINE - sizeof(uint32_t)];
+    /*
+     * Set by whoever owns the slots' backing memory when it needs to hear
+     * about released slots; the consumer notifies after advancing head
+     * only if this is set.
+     */
+    uint32_t notify_on_release;
+};
+
+static inline uint32_t pkt_ring_tail(volatile struct pkt_ring *r)
+{
+    return __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t pkt_ring_head(volatile struct pkt_ring *r)
+{
+    return __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+/* Make every slot before tail visible to the consumer */
+static inline void pkt_ring_publish(volatile struct pkt_ring *r, uint32_t tail)
+{
+    __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+}
+
+/* Hand every slot before head back to the producer */
+static inline void pkt_ring_release(volatile struct pkt_ring *r, uint32_t head)
+{
+    __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2025
+ * Adaptive request batching for rpc_queue clients
+ *
+ * rpc_submit() publishes requests and, if the server may be asleep,
+ * notifies it. Submitting each request as it is written therefore costs a
+ * notification, and a higher-priority server a switch there and back, per
+ * request. This layer holds requests back and submits them together when
+ * the first of these happens:
+ *
+ *   idle      nothing submitted earlier is still outstanding, so the
+ *             server has run out of work and no completion is coming to
+ *             wake the caller. Checked where the caller already stops to
+ *             look: on each completion wakeup and before it sleeps
+ *             (rpc_batch_idle()). Held requests would otherwise wait for
+ *             their deadline with the server doing nothing.
+ *   size      as many are waiting as the batch may hold: target, or fewer
+ *             if the rings have no room for more next to those in flight
+ *   deadline  the oldest has waited max_delay ticks. Checked as requests
+ *             are written and on each wakeup (rpc_batch_poll()); a caller
+ *             that sleeps with requests held is woken by the completions
+ *             it is waiting for, since rpc_batch_idle() holds nothing back
+ *             otherwise.
+ *
+ * target adapts to what it sees. Completion latency is averaged
+ * (EWMA, 1/8 weight); when the average is over latency_budget, target is
+ * halved. Otherwise, a batch that filled up to target suggests more
+ * demand than target, and target grows by one. A batch that went out on
+ * its deadline shows the demand, and target shrinks to that size. So
+ * under load batches grow until latency reaches the budget or the rings
+ * are full, and a light load waits at most max_delay. Header-only.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include "rpc_queue.h"
+
+enum rpc_flush {
+    RPC_FLUSH_IDLE,
+    RPC_FLUSH_SIZE,
+    RPC_FLUSH_DEADLINE,
+    RPC_FLUSH_REASONS,
+};
+
+struct rpc_batch {
+    struct rpc_client *c;
+    /* Requests to hold back before submitting, 1..RPC_QUEUE_SIZE */
+    unsigned target;
+    /* Ticks */
+    uint64_t max_delay;
+    uint64_t latency_budget;
+    uint64_t latency_ewma;
+    /* When the oldest request not yet submitted was written */
+    uint64_t first_pending;
+    /* Batches submitted, by reason */
+    uint64_t flushes[RPC_FLUSH_REASONS];
+};
+
+static inline void rpc_batch_init(struct rpc_batch *b, struct rpc_client *c, uint64_t max_delay,
+                                  uint64_t latency_budget)
+{
+    *b = (struct rpc_batch) {
+        .c = c,
+        .target = 1,
+        .max_delay = max_delay,
+        .latency_budget = latency_budget,
+    };
+}
+
+/* Requests submitted and not yet completed */
+static inline uint32_t rpc_batch_outstanding(const struct rpc_batch *b)
+{
+    return rpc_in_flight(b->c) - b->c->unsubmitted;
+}
+
+/* The most requests to hold back now: target, or what the rings have room for */
+static inline unsigned rpc_batch_limit(const struct rpc_batch *b)
+{
+    unsigned room = RPC_QUEUE_SIZE - rpc_batch_outstanding(b);
+    return b->target < room ? b->target : room;
+}
+
+static inline void rpc_batch_flush(struct rpc_batch *b, enum rpc_flush reason)
+{
+    unsigned size = b->c->unsubmitted;
+    if (size == 0) {
+        return;
+    }
+
+    if (b->latency_ewma > b->latency_budget) {
+        b->target = b->target > 1 ? b->target / 2 : 1;
+    } else if (reason == RPC_FLUSH_SIZE && size >= b->target && b->target < RPC_QUEUE_SIZE) {
+        b->target++;
+    } else if (reason == RPC_FLUSH_DEADLINE) {
+        b->target = size;
+    }
+
+    b->flushes[reason]++;
+    rpc_submit(b->c);
+}
+
+/* Call after filling in each request from rpc_sqe_next() */
+static inline void rpc_batch_queued(struct rpc_batch *b, uint64_t now)
+{
+    if (b->c->unsubmitted == 1) {
+        b->first_pending = now;
+    }
+
+    if (b->c->unsubmitted >= rpc_batch_limit(b)) {
+        rpc_batch_flush(b, RPC_FLUSH_SIZE);
+    } else if (now - b->first_pending >= b->max_delay) {
+        rpc_batch_flush(b, RPC_FLUSH_DEADLINE);
+    }
+}
+
+/* Call on each wakeup, so that no request outstays max_delay by more than a wakeup */
+static inline void rpc_batch_poll(struct rpc_batch *b, uint64_t now)
+{
+    if (b->c->unsubmitted != 0 && now - b->first_pending >= b->max_delay) {
+        rpc_batch_flush(b, RPC_FLUSH_DEADLINE);
+    }
+}
+
+/*
+ * Call after reaping completions on a wakeup, and before sleeping for
+ * completions: submits what is held if nothing is outstanding, as then the
+ * server is idle and no completion will come to wake the caller.
+ */
+static inline void rpc_batch_idle(struct rpc_batch *b)
+{
+    if (rpc_batch_outstanding(b) == 0) {
+        rpc_batch_flush(b, RPC_FLUSH_IDLE);
+    }
+}
+
+/* Call with each completion's latency, submission to completion, in ticks */
+static inline void rpc_batch_completed(struct rpc_batch *b, uint64_t latency)
+{
+    if (latency >= b->latency_ewma) {
+        b->latency_ewma += (latency - b->latency_ewma) / 8;
+    } else {
+        b->latency_ewma -= (b->latency_ewma - latency) / 8;
+    }
+}
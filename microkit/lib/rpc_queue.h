@@ -0,0 +1,217 @@
+/*
+ * Copyright 2025
+ * Asynchronous RPC between two PDs over submission and completion rings
+ *
+ * One region, mapped read-write into a client and a server, holds two
+ * single-producer/single-consumer rings with pkt_ring indices: requests
+ * (client produces, server consumes) and completions (server produces,
+ * client consumes). The client may have up to RPC_QUEUE_SIZE requests in
+ * flight and tags each with an id that its completion carries back, so
+ * completions need not come back in order. Payloads are small and
+ * travel in the entries; bulk data belongs in a separate region, as in
+ * blk_queue.h.
+ *
+ * Notifications are sent only when the peer may be asleep, in the manner
+ * of io_uring's SQ_NEED_WAKEUP and virtio's event suppression:
+ *
+ *   server_running  The client sets it when it publishes requests; if it
+ *                   was clear, the server may be asleep and the client
+ *                   notifies. The server clears it before it goes back to
+ *                   sleep and then looks at the ring once more, so a
+ *                   request published in between is never missed.
+ *   client_waiting  The client sets it before it goes back to sleep with
+ *                   requests in flight, and looks once more; the server
+ *                   notifies after publishing completions only if it
+ *                   clears it.
+ *
+ * So a busy pair exchanges no notifications at all, and a client that
+ * submits a batch pays for one. Both flags start clear in a zeroed
+ * region. The client never has more requests in flight than the
+ * completion ring holds, so the server never waits for space. Header-only.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+#include "pkt_ring.h"
+
+/* Power of two: the most requests in flight */
+#define RPC_QUEUE_SIZE 64
+#define RPC_PAYLOAD 48
+
+struct rpc_sqe {
+    /* Returned unchanged in the completion */
+    uint64_t id;
+    uint32_t op;
+    uint32_t len;
+    uint8_t payload[RPC_PAYLOAD];
+};
+
+struct rpc_cqe {
+    uint64_t id;
+    uint32_t status;
+    uint32_t len;
+    uint8_t payload[RPC_PAYLOAD];
+};
+
+struct rpc_queue {
+    struct pkt_ring sq;
+    struct pkt_ring cq;
+    uint32_t server_running;
+    uint8_t pad0[PKT_RING_CACHELINE - sizeof(uint32_t)];
+    uint32_t client_waiting;
+    uint8_t pad1[PKT_RING_CACHELINE - sizeof(uint32_t)];
+    struct rpc_sqe sqe[RPC_QUEUE_SIZE];
+    struct rpc_cqe cqe[RPC_QUEUE_SIZE];
+};
+
+_Static_assert(sizeof(struct rpc_sqe) == PKT_RING_CACHELINE, "rpc_sqe must fill one cache line");
+_Static_assert(sizeof(struct rpc_cqe) == PKT_RING_CACHELINE, "rpc_cqe must fill one cache line");
+
+/* Client side */
+
+struct rpc_client {
+    volatile struct rpc_queue *q;
+    /* Notification channel to the server */
+    microkit_channel ch;
+    /* Local copies of the indices this side owns */
+    uint32_t sq_tail;
+    uint32_t cq_head;
+    /* Requests written since the last rpc_submit() */
+    uint32_t unsubmitted;
+    /* Notifications sent to the server */
+    uint64_t notifies;
+};
+
+static inline uint32_t rpc_in_flight(const struct rpc_client *c)
+{
+    return c->sq_tail - c->cq_head;
+}
+
+/* The next request to fill in, or NULL if RPC_QUEUE_SIZE are in flight */
+static inline volatile struct rpc_sqe *rpc_sqe_next(struct rpc_client *c)
+{
+    if (rpc_in_flight(c) >= RPC_QUEUE_SIZE) {
+        return 0;
+    }
+    c->unsubmitted++;
+    return &c->q->sqe[c->sq_tail++ % RPC_QUEUE_SIZE];
+}
+
+/* Publish every request filled in since the last call; wake the server if it may be asleep */
+static inline void rpc_submit(struct rpc_client *c)
+{
+    if (c->unsubmitted == 0) {
+        return;
+    }
+    c->unsubmitted = 0;
+    pkt_ring_publish(&c->q->sq, c->sq_tail);
+    /* Orders the index store before the flag, against rpc_server_sleep() */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_exchange_n(&c->q->server_running, 1, __ATOMIC_SEQ_CST) == 0) {
+        c->notifies++;
+        microkit_notify(c->ch);
+    }
+}
+
+/* The oldest unread completion, or NULL */
+static inline const volatile struct rpc_cqe *rpc_cqe_next(struct rpc_client *c)
+{
+    if (c->cq_head == pkt_ring_tail(&c->q->cq)) {
+        return 0;
+    }
+    return &c->q->cqe[c->cq_head++ % RPC_QUEUE_SIZE];
+}
+
+/* Hand the completions read so far back to the server */
+static inline void rpc_cqe_release(struct rpc_client *c)
+{
+    pkt_ring_release(&c->q->cq, c->cq_head);
+}
+
+/*
+ * Call before going back to sleep with requests in flight. Returns 0 if
+ * completions arrived after all, and the caller should read them rather
+ * than sleep.
+ */
+static inline int rpc_client_sleep(struct rpc_client *c)
+{
+    __atomic_store_n(&c->q->client_waiting, 1, __ATOMIC_RELAXED);
+    /* Orders the flag before the index read, against rpc_server_flush() */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (c->cq_head != pkt_ring_tail(&c->q->cq)) {
+        __atomic_store_n(&c->q->client_waiting, 0, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return 1;
+}
+
+/* Server side */
+
+struct rpc_server {
+    volatile struct rpc_queue *q;
+    /* Notification channel to the client */
+    microkit_channel ch;
+    uint32_t sq_head;
+    uint32_t cq_tail;
+    /* Completions written since the last rpc_server_flush() */
+    uint32_t unflushed;
+    /* Notifications sent to the client */
+    uint64_t notifies;
+};
+
+/* The next request, or NULL */
+static inline const volatile struct rpc_sqe *rpc_sqe_peek(struct rpc_server *s)
+{
+    if (s->sq_head == pkt_ring_tail(&s->q->sq)) {
+        return 0;
+    }
+    return &s->q->sqe[s->sq_head % RPC_QUEUE_SIZE];
+}
+
+/* Where to write the completion of the request rpc_sqe_peek() returned */
+static inline volatile struct rpc_cqe *rpc_cqe_slot(struct rpc_server *s)
+{
+    return &s->q->cqe[s->cq_tail % RPC_QUEUE_SIZE];
+}
+
+static inline void rpc_complete(struct rpc_server *s)
+{
+    s->sq_head++;
+    s->cq_tail++;
+    s->unflushed++;
+}
+
+/* Publish the completions and free the requests; wake the client if it is waiting */
+static inline void rpc_server_flush(struct rpc_server *s)
+{
+    if (s->unflushed == 0) {
+        return;
+    }
+    s->unflushed = 0;
+    pkt_ring_release(&s->q->sq, s->sq_head);
+    pkt_ring_publish(&s->q->cq, s->cq_tail);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_exchange_n(&s->q->client_waiting, 0, __ATOMIC_SEQ_CST) != 0) {
+        s->notifies++;
+        microkit_notify(s->ch);
+    }
+}
+
+/*
+ * Call when the request ring looks empty, before going back to sleep.
+ * Returns 0 if requests arrived after all, and the caller should serve
+ * them rather than sleep.
+ */
+static inline int rpc_server_sleep(struct rpc_server *s)
+{
+    __atomic_store_n(&s->q->server_running, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (s->sq_head != pkt_ring_tail(&s->q->sq)) {
+        __atomic_store_n(&s->q->server_running, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2025
+ * Sorting and order statistics for benchmark samples
+ *
+ * Benchmark PDs keep their samples in a static array, sort it in place
+ * once a run is over and read the percentiles off the sorted array. The
+ * sort is a Shell sort with Ciura's gaps: no allocation and no recursion,
+ * and fast enough for a few thousand samples. Samples are uint32_t or
+ * uint64_t, in whatever unit the caller chose (usually counter ticks);
+ * stats_summary comes back in the same unit.
+ *
+ * Header-only, like timeout_heap.h.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+
+struct stats_summary {
+    uint64_t min;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+    uint64_t avg;
+};
+
+static const unsigned stats_gaps[] = { 701, 301, 132, 57, 23, 10, 4, 1 };
+
+#define STATS_SHELL_SORT(type, v, n) \
+    for (unsigned g = 0; g < sizeof(stats_gaps) / sizeof(stats_gaps[0]); g++) { \
+        unsigned gap = stats_gaps[g]; \
+        for (unsigned i = gap; i < (n); i++) { \
+            type x = (v)[i]; \
+            unsigned j = i; \
+            while (j >= gap && (v)[j - gap] > x) { \
+                (v)[j] = (v)[j - gap]; \
+                j -= gap; \
+            } \
+            (v)[j] = x; \
+        } \
+    }
+
+static inline void stats_sort_u32(uint32_t *v, unsigned n)
+{
+    STATS_SHELL_SORT(uint32_t, v, n)
+}
+
+static inline void stats_sort_u64(uint64_t *v, unsigned n)
+{
+    STATS_SHELL_SORT(uint64_t, v, n)
+}
+
+/* Index of the per_mille'th percentile in a sorted array of n > 0 */
+static inline unsigned stats_rank(unsigned n, unsigned per_mille)
+{
+    return (uint64_t)n * per_mille / 1000;
+}
+
+/* Sorts v and summarises it; all zeros if n is 0 */
+static inline struct stats_summary stats_summarize_u32(uint32_t *v, unsigned n)
+{
+    struct stats_summary s = { 0 };
+    if (n == 0) {
+        return s;
+    }
+    stats_sort_u32(v, n);
+    for (unsigned i = 0; i < n; i++) {
+        s.avg += v[i];
+    }
+    s.avg /= n;
+    s.min = v[0];
+    s.p50 = v[stats_rank(n, 500)];
+    s.p99 = v[stats_rank(n, 990)];
+    s.p999 = v[stats_rank(n, 999)];
+    s.max = v[n - 1];
+    return s;
+}
+
+static inline struct stats_summary stats_summarize_u64(uint64_t *v, unsigned n)
+{
+    struct stats_summary s = { 0 };
+    if (n == 0) {
+        return s;
+    }
+    stats_sort_u64(v, n);
+    for (unsigned i = 0; i < n; i++) {
+        s.avg += v[i];
+    }
+    s.avg /= n;
+    s.min = v[0];
+    s.p50 = v[stats_rank(n, 500)];
+    s.p99 = v[stats_rank(n, 990)];
+    s.p999 = v[stats_rank(n, 999)];
+    s.max = v[n - 1];
+    return s;
+}
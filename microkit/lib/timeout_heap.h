@@ -0,0 +1,127 @@
+/*
+ * Copyright 2025
+ * Per-channel timeout queue for timer PDs
+ *
+ * A binary min-heap of absolute 64-bit deadlines holding at most one
+ * timeout per channel. pos[ch] is the channel's index in the heap, or -1
+ * if it has no timeout, so arming, re-arming, cancelling and expiring are
+ * all O(log n) and the earliest deadline is always entry[0]. The unit of
+ * the deadlines is up to the timer driver.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+
+struct timeout {
+    uint64_t deadline;
+    microkit_channel ch;
+};
+
+struct timeout_heap {
+    unsigned size;
+    int pos[MICROKIT_MAX_CHANNELS];
+    struct timeout entry[MICROKIT_MAX_CHANNELS];
+};
+
+static inline void timeout_heap_init(struct timeout_heap *h)
+{
+    h->size = 0;
+    for (unsigned i = 0; i < MICROKIT_MAX_CHANNELS; i++) {
+        h->pos[i] = -1;
+    }
+}
+
+static inline void timeout_heap_set(struct timeout_heap *h, unsigned i, struct timeout t)
+{
+    h->entry[i] = t;
+    h->pos[t.ch] = i;
+}
+
+static inline void timeout_heap_sift_up(struct timeout_heap *h, unsigned i)
+{
+    struct timeout t = h->entry[i];
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (h->entry[parent].deadline <= t.deadline) {
+            break;
+        }
+        timeout_heap_set(h, i, h->entry[parent]);
+        i = parent;
+    }
+    timeout_heap_set(h, i, t);
+}
+
+static inline void timeout_heap_sift_down(struct timeout_heap *h, unsigned i)
+{
+    struct timeout t = h->entry[i];
+    for (;;) {
+        unsigned child = 2 * i + 1;
+        if (child >= h->size) {
+            break;
+        }
+        if (child + 1 < h->size && h->entry[child + 1].deadline < h->entry[child].deadline) {
+            child++;
+        }
+        if (t.deadline <= h->entry[child].deadline) {
+            break;
+        }
+        timeout_heap_set(h, i, h->entry[child]);
+        i = child;
+    }
+    timeout_heap_set(h, i, t);
+}
+
+static inline int timeout_heap_empty(const struct timeout_heap *h)
+{
+    return h->size == 0;
+}
+
+/* Earliest pending timeout; only valid when the heap is not empty */
+static inline const struct timeout *timeout_heap_min(const struct timeout_heap *h)
+{
+    return &h->entry[0];
+}
+
+/* Arm a timeout for ch, replacing the one it already had */
+static inline void timeout_heap_update(struct timeout_heap *h, microkit_channel ch, uint64_t deadline)
+{
+    int i = h->pos[ch];
+    if (i < 0) {
+        i = h->size++;
+        timeout_heap_set(h, i, (struct timeout) { .deadline = deadline, .ch = ch });
+        timeout_heap_sift_up(h, i);
+        return;
+    }
+
+    uint64_t old = h->entry[i].deadline;
+    h->entry[i].deadline = deadline;
+    if (deadline < old) {
+        timeout_heap_sift_up(h, i);
+    } else {
+        timeout_heap_sift_down(h, i);
+    }
+}
+
+/* Drop ch's timeout, if it has one */
+static inline void timeout_heap_cancel(struct timeout_heap *h, microkit_channel ch)
+{
+    int i = h->pos[ch];
+    if (i < 0) {
+        return;
+    }
+
+    h->pos[ch] = -1;
+    h->size--;
+    if ((unsigned)i == h->size) {
+        return;
+    }
+    struct timeout moved = h->entry[h->size];
+    timeout_heap_set(h, i, moved);
+    timeout_heap_sift_up(h, i);
+    if (h->pos[moved.ch] == i) {
+        timeout_heap_sift_down(h, i);
+    }
+}
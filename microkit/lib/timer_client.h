@@ -0,0 +1,52 @@
+/*
+ * Copyright 2025
+ * Client interface to the timer PD (microkit/timer)
+ *
+ * All calls are protected calls on the client's channel to the timer PD.
+ * Times are nanoseconds since boot. An expired timeout arrives as a
+ * notification on the same channel. Each channel has at most one timeout,
+ * one-shot or periodic, and arming a new one replaces it.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+
+enum timer_label {
+    /* -> MR0: current time */
+    TIMER_GET_TIME = 0,
+    /* MR0: delay; notify once after it */
+    TIMER_SET_TIMEOUT = 1,
+    /* MR0: period; notify every period, starting one period from now */
+    TIMER_SET_PERIODIC = 2,
+    TIMER_CANCEL = 3,
+};
+
+#define NS_IN_US 1000ULL
+#define NS_IN_MS 1000000ULL
+#define NS_IN_S  1000000000ULL
+
+static inline uint64_t timer_time_ns(microkit_channel ch)
+{
+    (void) microkit_ppcall(ch, microkit_msginfo_new(TIMER_GET_TIME, 0));
+    return seL4_GetMR(0);
+}
+
+static inline void timer_set_timeout(microkit_channel ch, uint64_t delay_ns)
+{
+    seL4_SetMR(0, delay_ns);
+    (void) microkit_ppcall(ch, microkit_msginfo_new(TIMER_SET_TIMEOUT, 1));
+}
+
+static inline void timer_set_periodic(microkit_channel ch, uint64_t period_ns)
+{
+    seL4_SetMR(0, period_ns);
+    (void) microkit_ppcall(ch, microkit_msginfo_new(TIMER_SET_PERIODIC, 1));
+}
+
+static inline void timer_cancel(microkit_channel ch)
+{
+    (void) microkit_ppcall(ch, microkit_msginfo_new(TIMER_CANCEL, 0));
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2025
+ * Portable timestamps for PDs
+ *
+ * One free-running counter that every PD on the system reads, so stamps
+ * taken in different PDs compare directly:
+ *
+ *   AArch64  CNTPCT_EL0, the generic timer's physical count, at the rate
+ *            in CNTFRQ_EL0. The isb keeps the read from being hoisted
+ *            above the code it times.
+ *   RISC-V   the time CSR (rdtime), at the platform's timebase. The
+ *            timebase is not readable from user mode, so it comes from
+ *            TIMING_RISCV_FREQ, QEMU virt's 10 MHz by default. rdcycle is
+ *            not used: its rate follows the core clock, which QEMU does
+ *            not model, and the kernel need not enable it for user mode.
+ *
+ * Both run at a few tens of MHz at most under QEMU, so a single reading
+ * resolves tens of nanoseconds; time many operations, not one. Header-only.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifndef TIMING_RISCV_FREQ
+#define TIMING_RISCV_FREQ 10000000
+#endif
+
+static inline uint64_t timing_now(void)
+{
+    uint64_t val;
+#if defined(__aarch64__)
+    __asm__ volatile("isb; mrs %0, cntpct_el0" : "=r" (val) : : "memory");
+#elif defined(__riscv)
+    __asm__ volatile("rdtime %0" : "=r" (val) : : "memory");
+#else
+#error "timing_now: unsupported architecture"
+#endif
+    return val;
+}
+
+/* Counter ticks per second */
+static inline uint64_t timing_freq(void)
+{
+#if defined(__aarch64__)
+    uint64_t freq;
+    __asm__ volatile("mrs %0, cntfrq_el0" : "=r" (freq));
+    return freq;
+#else
+    return TIMING_RISCV_FREQ;
+#endif
+}
+
+/* Split so that long intervals do not overflow the multiplication */
+static inline uint64_t timing_ticks_to_ns(uint64_t ticks)
+{
+    uint64_t freq = timing_freq();
+    return ticks / freq * 1000000000ULL + ticks % freq * 1000000000ULL / freq;
+}
+
+static inline uint64_t timing_ticks_to_us(uint64_t ticks)
+{
+    uint64_t freq = timing_freq();
+    return ticks / freq * 1000000ULL + ticks % freq * 1000000ULL / freq;
+}
+
+/* Name of the counter, for reports that compare architectures */
+static inline const char *timing_source(void)
+{
+#if defined(__aarch64__)
+    return "cntpct";
+#else
+    return "rdtime";
+#endif
+}
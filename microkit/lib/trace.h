@@ -0,0 +1,161 @@
+/*
+ * Copyright 2025
+ * Per-PD tracepoint buffers
+ *
+ * Each traced PD owns one trace buffer in its own region, mapped
+ * read-write into it and read-only into the PD that dumps the traces
+ * (the logger, in ipc_demo). trace_begin() and trace_end() bracket a
+ * span, trace_instant() marks a point; each appends one fixed-size event
+ * stamped with the counter. Nothing is formatted or sent on the traced
+ * path: the dumping PD prints the events it has not printed yet with
+ * trace_dump(), and scripts/trace_to_chrome.py turns the console log into
+ * Chrome trace JSON for chrome://tracing or ui.perfetto.dev.
+ *
+ * The buffer fills once and then drops, so a trace covers the start of a
+ * run. Tracepoints compile to nothing unless the PD is built with
+ * -DTRACE=1.
+ *
+ * A PD that traces declares "uintptr_t trace_vaddr;" and maps its buffer
+ * there with setvar_vaddr="trace_vaddr". Header-only, like log_ring.h.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+
+#ifndef TRACE
+#define TRACE 0
+#endif
+
+/* Size of each PD's trace region */
+#define TRACE_BUFFER_SIZE 0x4000
+#define TRACE_CACHELINE 64
+#define TRACE_NAME_LEN 23
+
+/* Chrome trace event phases */
+#define TRACE_BEGIN 'B'
+#define TRACE_END 'E'
+#define TRACE_INSTANT 'i'
+
+struct trace_event {
+    /* Counter value when the event was recorded */
+    uint64_t timestamp;
+    char phase;
+    /* NUL-terminated, truncated to fit */
+    char name[TRACE_NAME_LEN];
+};
+
+struct trace_buffer {
+    /* Owner-written: events before count are complete */
+    uint64_t count;
+    /* Owner-written: events dropped because the buffer was full */
+    uint64_t dropped;
+    uint8_t pad[TRACE_CACHELINE - 2 * sizeof(uint64_t)];
+    struct trace_event events[];
+};
+
+#define TRACE_EVENTS ((TRACE_BUFFER_SIZE - sizeof(struct trace_buffer)) / sizeof(struct trace_event))
+
+_Static_assert(sizeof(struct trace_event) == 32, "trace_event must pack two to a cache line");
+
+extern uintptr_t trace_vaddr;
+
+/* Traced side */
+
+static inline void trace_record(char phase, const char *name)
+{
+    volatile struct trace_buffer *buf = (volatile struct trace_buffer *)trace_vaddr;
+    uint64_t count = buf->count;
+
+    if (count >= TRACE_EVENTS) {
+        buf->dropped++;
+        return;
+    }
+
+    volatile struct trace_event *e = &buf->events[count];
+    e->timestamp = timing_now();
+    unsigned i = 0;
+    for (; i < TRACE_NAME_LEN - 1 && name[i] != '\0'; i++) {
+        e->name[i] = name[i];
+    }
+    e->name[i] = '\0';
+    e->phase = phase;
+
+    __atomic_store_n(&buf->count, count + 1, __ATOMIC_RELEASE);
+}
+
+static inline void trace_begin(const char *name)
+{
+    if (TRACE) {
+        trace_record(TRACE_BEGIN, name);
+    }
+}
+
+static inline void trace_end(const char *name)
+{
+    if (TRACE) {
+        trace_record(TRACE_END, name);
+    }
+}
+
+static inline void trace_instant(const char *name)
+{
+    if (TRACE) {
+        trace_record(TRACE_INSTANT, name);
+    }
+}
+
+/* Dumping side */
+
+struct trace_source {
+    const volatile struct trace_buffer *buf;
+    /* PD name printed with each event; becomes the thread name in the trace */
+    const char *name;
+    /* Events printed so far */
+    uint64_t dumped;
+    /* buf->dropped as of the last dump */
+    uint64_t dropped_seen;
+};
+
+/*
+ * Print each event recorded since the last call as
+ *   TRACE|EVENT: pd=<name> ph=<B|E|i> ts_ns=<time> name=<event>
+ * and any new drops as TRACE|WARN. Call it whenever the traced PDs may
+ * have recorded something, and once more at the end of the run.
+ */
+static inline void trace_dump(struct trace_source *src)
+{
+    if (!TRACE) {
+        return;
+    }
+
+    uint64_t count = __atomic_load_n(&src->buf->count, __ATOMIC_ACQUIRE);
+    /* Written by the traced PD, so bound it by what the buffer holds */
+    count = count > TRACE_EVENTS ? TRACE_EVENTS : count;
+    for (; src->dumped < count; src->dumped++) {
+        const volatile struct trace_event *e = &src->buf->events[src->dumped];
+        microkit_dbg_puts("TRACE|EVENT: pd=");
+        microkit_dbg_puts(src->name);
+        microkit_dbg_puts(" ph=");
+        microkit_dbg_putc(e->phase);
+        dbg_put_kv("ts_ns", timing_ticks_to_ns(e->timestamp));
+        microkit_dbg_puts(" name=");
+        for (unsigned i = 0; i < TRACE_NAME_LEN && e->name[i] != '\0'; i++) {
+            microkit_dbg_putc(e->name[i]);
+        }
+        microkit_dbg_puts("\n");
+    }
+
+    uint64_t dropped = src->buf->dropped;
+    if (dropped != src->dropped_seen) {
+        microkit_dbg_puts("TRACE|WARN: pd=");
+        microkit_dbg_puts(src->name);
+        dbg_put_kv("dropped", dropped - src->dropped_seen);
+        microkit_dbg_puts("\n");
+        src->dropped_seen = dropped;
+    }
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2025
+ * virtio-mmio transport and split virtqueue definitions
+ *
+ * Only the modern (version 2) MMIO transport is supported; QEMU must be
+ * started with -global virtio-mmio.force-legacy=false. Layouts follow
+ * the virtio 1.2 specification, sections 2.7 and 4.2.2.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+
+/* MMIO register offsets */
+#define VIRTIO_MMIO_MAGIC_VALUE         0x000
+#define VIRTIO_MMIO_VERSION             0x004
+#define VIRTIO_MMIO_DEVICE_ID           0x008
+#define VIRTIO_MMIO_VENDOR_ID           0x00c
+#define VIRTIO_MMIO_DEVICE_FEATURES     0x010
+#define VIRTIO_MMIO_DEVICE_FEATURES_SEL 0x014
+#define VIRTIO_MMIO_DRIVER_FEATURES     0x020
+#define VIRTIO_MMIO_DRIVER_FEATURES_SEL 0x024
+#define VIRTIO_MMIO_QUEUE_SEL           0x030
+#define VIRTIO_MMIO_QUEUE_NUM_MAX       0x034
+#define VIRTIO_MMIO_QUEUE_NUM           0x038
+#define VIRTIO_MMIO_QUEUE_READY         0x044
+#define VIRTIO_MMIO_QUEUE_NOTIFY        0x050
+#define VIRTIO_MMIO_INTERRUPT_STATUS    0x060
+#define VIRTIO_MMIO_INTERRUPT_ACK       0x064
+#define VIRTIO_MMIO_STATUS              0x070
+#define VIRTIO_MMIO_QUEUE_DESC_LOW      0x080
+#define VIRTIO_MMIO_QUEUE_DESC_HIGH     0x084
+#define VIRTIO_MMIO_QUEUE_DRIVER_LOW    0x090
+#define VIRTIO_MMIO_QUEUE_DRIVER_HIGH   0x094
+#define VIRTIO_MMIO_QUEUE_DEVICE_LOW    0x0a0
+#define VIRTIO_MMIO_QUEUE_DEVICE_HIGH   0x0a4
+#define VIRTIO_MMIO_CONFIG              0x100
+
+#define VIRTIO_MMIO_MAGIC 0x74726976 /* "virt" */
+
+#define VIRTIO_DEVICE_ID_NET   1
+#define VIRTIO_DEVICE_ID_BLOCK 2
+
+/* Device status bits */
+#define VIRTIO_STATUS_ACKNOWLEDGE 1
+#define VIRTIO_STATUS_DRIVER      2
+#define VIRTIO_STATUS_DRIVER_OK   4
+#define VIRTIO_STATUS_FEATURES_OK 8
+#define VIRTIO_STATUS_FAILED      128
+
+/* Transport feature bits, numbered across both 32-bit feature words */
+#define VIRTIO_F_VERSION_1 32
+
+#define VIRTIO_INT_USED_RING 1
+#define VIRTIO_INT_CONFIG    2
+
+#define VIRTQ_DESC_F_NEXT  1
+#define VIRTQ_DESC_F_WRITE 2
+
+#define VIRTQ_AVAIL_F_NO_INTERRUPT 1
+
+struct virtq_desc {
+    uint64_t addr;
+    uint32_t len;
+    uint16_t flags;
+    uint16_t next;
+};
+
+struct virtq_avail {
+    uint16_t flags;
+    uint16_t idx;
+    uint16_t ring[];
+};
+
+struct virtq_used_elem {
+    uint32_t id;
+    uint32_t len;
+};
+
+struct virtq_used {
+    uint16_t flags;
+    uint16_t idx;
+    struct virtq_used_elem ring[];
+};
+
+/*
+ * Driver-side view of one split virtqueue. The three parts live in
+ * memory the device can reach; num must be a power of two.
+ */
+struct virtq {
+    uint16_t num;
+    volatile struct virtq_desc *desc;
+    volatile struct virtq_avail *avail;
+    volatile struct virtq_used *used;
+    /* Next avail slot to fill and next used slot to consume */
+    uint16_t avail_idx;
+    uint16_t last_used;
+};
+
+/*
+ * Descriptor table at 0, avail ring and used ring each on their own
+ * 4 KiB page after it. num <= 256 keeps every part inside its page.
+ */
+#define VIRTQ_AVAIL_OFFSET 0x1000
+#define VIRTQ_USED_OFFSET  0x2000
+#define VIRTQ_REGION_SIZE  0x3000
+
+static inline uint32_t virtio_read32(uintptr_t regs, uint32_t off)
+{
+    return *(volatile uint32_t *)(regs + off);
+}
+
+static inline void virtio_write32(uintptr_t regs, uint32_t off, uint32_t val)
+{
+    *(volatile uint32_t *)(regs + off) = val;
+}
+
+/* Order our ring writes against the device (which may run on another CPU under KVM) */
+static inline void virtio_mb(void)
+{
+#if defined(__aarch64__)
+    asm volatile("dmb sy" ::: "memory");
+#else
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+/*
+ * Reset the device and negotiate features: ACKNOWLEDGE, DRIVER, then
+ * FEATURES_OK with VIRTIO_F_VERSION_1 plus whichever of want_features
+ * (bits 0..31) the device offers. Returns the accepted device feature
+ * bits, or -1 if the device is missing or refuses.
+ */
+static inline int64_t virtio_mmio_negotiate(uintptr_t regs, uint32_t device_id, uint32_t want_features)
+{
+    if (virtio_read32(regs, VIRTIO_MMIO_MAGIC_VALUE) != VIRTIO_MMIO_MAGIC ||
+        virtio_read32(regs, VIRTIO_MMIO_VERSION) != 2 ||
+        virtio_read32(regs, VIRTIO_MMIO_DEVICE_ID) != device_id) {
+        return -1;
+    }
+
+    virtio_write32(regs, VIRTIO_MMIO_STATUS, 0);
+    virtio_write32(regs, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE);
+    virtio_write32(regs, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER);
+
+    virtio_write32(regs, VIRTIO_MMIO_DEVICE_FEATURES_SEL, 1);
+    if (!(virtio_read32(regs, VIRTIO_MMIO_DEVICE_FEATURES) & (1u << (VIRTIO_F_VERSION_1 - 32)))) {
+        virtio_write32(regs, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+        return -1;
+    }
+    virtio_write32(regs, VIRTIO_MMIO_DEVICE_FEATURES_SEL, 0);
+    uint32_t features = virtio_read32(regs, VIRTIO_MMIO_DEVICE_FEATURES) & want_features;
+
+    virtio_write32(regs, VIRTIO_MMIO_DRIVER_FEATURES_SEL, 0);
+    virtio_write32(regs, VIRTIO_MMIO_DRIVER_FEATURES, features);
+    virtio_write32(regs, VIRTIO_MMIO_DRIVER_FEATURES_SEL, 1);
+    virtio_write32(regs, VIRTIO_MMIO_DRIVER_FEATURES, 1u << (VIRTIO_F_VERSION_1 - 32));
+
+    uint32_t status = VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER | VIRTIO_STATUS_FEATURES_OK;
+    virtio_write32(regs, VIRTIO_MMIO_STATUS, status);
+    if (!(virtio_read32(regs, VIRTIO_MMIO_STATUS) & VIRTIO_STATUS_FEATURES_OK)) {
+        virtio_write32(regs, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+        return -1;
+    }
+
+    return features;
+}
+
+/*
+ * Lay out queue index qidx in the VIRTQ_REGION_SIZE bytes at vaddr/paddr
+ * and hand it to the device. Returns 0 on success.
+ */
+static inline int virtio_mmio_queue_setup(uintptr_t regs, uint32_t qidx, struct virtq *vq,
+                                          uintptr_t vaddr, uint64_t paddr, uint16_t num)
+{
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_SEL, qidx);
+    if (virtio_read32(regs, VIRTIO_MMIO_QUEUE_READY) != 0 ||
+        virtio_read32(regs, VIRTIO_MMIO_QUEUE_NUM_MAX) < num) {
+        return -1;
+    }
+
+    vq->num = num;
+    vq->desc = (volatile struct virtq_desc *)vaddr;
+    vq->avail = (volatile struct virtq_avail *)(vaddr + VIRTQ_AVAIL_OFFSET);
+    vq->used = (volatile struct virtq_used *)(vaddr + VIRTQ_USED_OFFSET);
+    vq->avail_idx = 0;
+    vq->last_used = 0;
+
+    uint64_t avail_paddr = paddr + VIRTQ_AVAIL_OFFSET;
+    uint64_t used_paddr = paddr + VIRTQ_USED_OFFSET;
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_NUM, num);
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_DESC_LOW, (uint32_t)paddr);
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_DESC_HIGH, (uint32_t)(paddr >> 32));
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_DRIVER_LOW, (uint32_t)avail_paddr);
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_DRIVER_HIGH, (uint32_t)(avail_paddr >> 32));
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_DEVICE_LOW, (uint32_t)used_paddr);
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_DEVICE_HIGH, (uint32_t)(used_paddr >> 32));
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_READY, 1);
+
+    return 0;
+}
+
+/* Queue descriptor head for the device; visible after virtq_kick() */
+static inline void virtq_push(struct virtq *vq, uint16_t head)
+{
+    vq->avail->ring[vq->avail_idx & (vq->num - 1)] = head;
+    vq->avail_idx++;
+}
+
+/* Publish everything pushed so far and notify the device once */
+static inline void virtq_kick(uintptr_t regs, uint32_t qidx, struct virtq *vq)
+{
+    virtio_mb();
+    vq->avail->idx = vq->avail_idx;
+    virtio_mb();
+    virtio_write32(regs, VIRTIO_MMIO_QUEUE_NOTIFY, qidx);
+}
+
+/* Returns 1 and fills *elem if the device has completed another descriptor chain */
+static inline int virtq_pop_used(struct virtq *vq, struct virtq_used_elem *elem)
+{
+    if (vq->last_used == vq->used->idx) {
+        return 0;
+    }
+    virtio_mb();
+    volatile struct virtq_used_elem *e = &vq->used->ring[vq->last_used & (vq->num - 1)];
+    elem->id = e->id;
+    elem->len = e->len;
+    vq->last_used++;
+    return 1;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Timer Service (ARM generic timer)
+ *
+ * Multiplexes the EL1 physical timer (CNTP, PPI 30) across clients on
+ * qemu_virt_aarch64. The kernel schedules with the hypervisor timer and
+ * exports CNTP to user level, so this PD programs it with plain system
+ * register accesses and needs no MMIO mapping. See timer_client.h for
+ * the protected call interface.
+ *
+ * The comparator is 64 bits and level triggered: a deadline that has
+ * already passed when it is written fires at once, so unlike the GPT
+ * there are no epochs to track and no match to miss.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+#include "timeout_heap.h"
+#include "timer_client.h"
+
+#define IRQ_CH 0
+
+#define CNTP_CTL_ENABLE (1 << 0)
+
+/*
+ * The comparator is set this long after the earliest deadline and every
+ * timeout due by then is delivered on the same interrupt. A timeout is
+ * never early and at most TIMER_SLACK_NS late.
+ */
+#ifndef TIMER_SLACK_NS
+#define TIMER_SLACK_NS (10 * NS_IN_US)
+#endif
+
+/* Deadlines are in counter ticks */
+static struct timeout_heap timeouts;
+/* Period in ticks for periodic timeouts, 0 for one-shot */
+static uint64_t period[MICROKIT_MAX_CHANNELS];
+
+static uint64_t freq;
+static uint64_t slack_ticks;
+
+static inline void write_cval(uint64_t cval)
+{
+    __asm__ volatile("msr cntp_cval_el0, %0" : : "r" (cval));
+}
+
+static inline void write_ctl(uint64_t ctl)
+{
+    __asm__ volatile("msr cntp_ctl_el0, %0; isb" : : "r" (ctl));
+}
+
+static uint64_t ns_to_ticks(uint64_t ns)
+{
+    return (ns / NS_IN_S) * freq + ((ns % NS_IN_S) * freq + NS_IN_S - 1) / NS_IN_S;
+}
+
+/* A "never" timeout must not wrap round to the past */
+static inline uint64_t add_sat(uint64_t a, uint64_t b)
+{
+    return a + b < a ? UINT64_MAX : a + b;
+}
+
+/*
+ * Deliver everything that is due, re-arm periodic timeouts, and program
+ * the comparator for what is left. A periodic client that has fallen
+ * more than a period behind gets one notification, not a burst, and
+ * keeps its original phase.
+ */
+static void
+expire_and_rearm(void)
+{
+    uint64_t now = timing_now();
+
+    while (!timeout_heap_empty(&timeouts) && timeout_heap_min(&timeouts)->deadline <= now) {
+        const struct timeout *t = timeout_heap_min(&timeouts);
+        microkit_channel ch = t->ch;
+
+        if (period[ch]) {
+            uint64_t missed = (now - t->deadline) / period[ch];
+            timeout_heap_update(&timeouts, ch, t->deadline + (missed + 1) * period[ch]);
+        } else {
+            timeout_heap_cancel(&timeouts, ch);
+        }
+        microkit_notify(ch);
+    }
+
+    if (timeout_heap_empty(&timeouts)) {
+        write_ctl(0);
+        return;
+    }
+
+    write_cval(add_sat(timeout_heap_min(&timeouts)->deadline, slack_ticks));
+    write_ctl(CNTP_CTL_ENABLE);
+}
+
+void
+init(void)
+{
+    freq = timing_freq();
+    slack_ticks = ns_to_ticks(TIMER_SLACK_NS);
+
+    timeout_heap_init(&timeouts);
+    write_ctl(0);
+
+    microkit_dbg_puts("TIMER|INFO: generic timer");
+    dbg_put_kv("freq_hz", freq);
+    dbg_put_kv("slack_ns", TIMER_SLACK_NS);
+    microkit_dbg_puts("\n");
+}
+
+void
+notified(microkit_channel ch)
+{
+    switch (ch) {
+        case IRQ_CH:
+            /* Level triggered: move or disable the comparator before acking */
+            expire_and_rearm();
+            microkit_irq_ack(ch);
+            break;
+
+        default:
+            microkit_dbg_puts("TIMER|ERROR: notification on unexpected channel\n");
+            break;
+    }
+}
+
+seL4_MessageInfo_t
+protected(microkit_channel ch, microkit_msginfo msginfo)
+{
+    switch (microkit_msginfo_get_label(msginfo)) {
+        case TIMER_GET_TIME:
+            seL4_SetMR(0, timing_ticks_to_ns(timing_now()));
+            return microkit_msginfo_new(0, 1);
+
+        case TIMER_SET_TIMEOUT:
+        case TIMER_SET_PERIODIC: {
+            uint64_t ticks = ns_to_ticks(seL4_GetMR(0));
+            int periodic = microkit_msginfo_get_label(msginfo) == TIMER_SET_PERIODIC;
+
+            if (periodic && ticks == 0) {
+                return microkit_msginfo_new(1, 0);
+            }
+            period[ch] = periodic ? ticks : 0;
+            /* Absolute from here, however long this call is preempted */
+            timeout_heap_update(&timeouts, ch, add_sat(timing_now(), ticks));
+            expire_and_rearm();
+            return microkit_msginfo_new(0, 0);
+        }
+
+        case TIMER_CANCEL:
+            timeout_heap_cancel(&timeouts, ch);
+            expire_and_rearm();
+            return microkit_msginfo_new(0, 0);
+    }
+
+    return microkit_msginfo_new(1, 0);
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Timer Service Demo
+ *
+ * Exercises the timer PD the way other PDs are expected to use it: a
+ * series of one-shot sleeps, then a periodic tick. Reports how late
+ * each notification arrived, measured against the time the client asked
+ * for, plus the cost of a get-time call.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timer_client.h"
+
+#define TIMER_CH 0
+
+static const uint64_t oneshot_ns[] = { 100 * NS_IN_US, NS_IN_MS, 10 * NS_IN_MS, 100 * NS_IN_MS };
+#define NUM_ONESHOT (sizeof(oneshot_ns) / sizeof(oneshot_ns[0]))
+
+#define PERIOD_NS NS_IN_MS
+#define PERIODIC_SAMPLES 1000
+
+#define GET_TIME_CALLS 1000
+
+static unsigned oneshot_index;
+static uint64_t expected_ns;
+
+static uint64_t samples;
+static uint64_t late_sum_ns;
+static uint64_t late_max_ns;
+/* Periods skipped because a notification came more than a period late */
+static uint64_t missed_periods;
+
+static void start_oneshot(void)
+{
+    expected_ns = timer_time_ns(TIMER_CH) + oneshot_ns[oneshot_index];
+    timer_set_timeout(TIMER_CH, oneshot_ns[oneshot_index]);
+}
+
+static void periodic_report(void)
+{
+    microkit_dbg_puts("TIMER|METRIC: mode=periodic");
+    dbg_put_kv("period_us", PERIOD_NS / NS_IN_US);
+    dbg_put_kv("samples", samples);
+    dbg_put_kv("late_avg_ns", late_sum_ns / samples);
+    dbg_put_kv("late_max_ns", late_max_ns);
+    dbg_put_kv("missed", missed_periods);
+    microkit_dbg_puts("\n");
+}
+
+void init(void)
+{
+    uint64_t start = timer_time_ns(TIMER_CH);
+    for (unsigned i = 0; i < GET_TIME_CALLS; i++) {
+        (void) timer_time_ns(TIMER_CH);
+    }
+    uint64_t end = timer_time_ns(TIMER_CH);
+
+    microkit_dbg_puts("TIMER|METRIC: mode=get_time");
+    dbg_put_kv("calls", GET_TIME_CALLS);
+    dbg_put_kv("ns_per_call", (end - start) / (GET_TIME_CALLS + 1));
+    microkit_dbg_puts("\n");
+
+    start_oneshot();
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != TIMER_CH) {
+        microkit_dbg_puts("TIMER|ERROR: demo notified on unexpected channel\n");
+        return;
+    }
+
+    uint64_t now = timer_time_ns(TIMER_CH);
+    /* The timer's tick rounding can deliver a hair early */
+    uint64_t late = now > expected_ns ? now - expected_ns : 0;
+
+    if (oneshot_index < NUM_ONESHOT) {
+        microkit_dbg_puts("TIMER|METRIC: mode=oneshot");
+        dbg_put_kv("timeout_us", oneshot_ns[oneshot_index] / NS_IN_US);
+        dbg_put_kv("late_ns", late);
+        microkit_dbg_puts("\n");
+
+        if (++oneshot_index < NUM_ONESHOT) {
+            start_oneshot();
+        } else {
+            expected_ns = timer_time_ns(TIMER_CH) + PERIOD_NS;
+            timer_set_periodic(TIMER_CH, PERIOD_NS);
+        }
+        return;
+    }
+
+    samples++;
+    late_sum_ns += late;
+    if (late > late_max_ns) {
+        late_max_ns = late;
+    }
+    /* The timer PD re-arms past now, skipping whole periods; so does the deadline */
+    uint64_t missed = late / PERIOD_NS;
+    missed_periods += missed;
+    expected_ns += (missed + 1) * PERIOD_NS;
+
+    if (samples == PERIODIC_SAMPLES) {
+        timer_cancel(TIMER_CH);
+        periodic_report();
+        microkit_dbg_puts("TIMER|INFO: done\n");
+    }
+}
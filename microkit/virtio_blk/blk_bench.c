@@ -0,0 +1,236 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Block I/O Benchmark
+ *
+ * Client of the virtio-blk driver. For each block size and queue depth it
+ * keeps qd requests in flight at random block-aligned offsets until a
+ * fixed number have completed, first writing and then reading back, and
+ * reports IOPS, bandwidth and mean per-request latency. Entirely event
+ * driven: requests are refilled from the driver's completion notification.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "blk_queue.h"
+#include "dbg.h"
+#include "timing.h"
+
+#define BLK_CH 0
+
+uintptr_t blk_queue_vaddr;
+uintptr_t blk_data_vaddr;
+uint64_t blk_data_size;
+
+#define QUEUE ((volatile struct blk_queue *)blk_queue_vaddr)
+
+static const uint32_t block_sizes[] = { 512, 4096, 16384, 65536 };
+static const uint32_t queue_depths[] = { 1, 4, 16, 32 };
+static const uint32_t ops[] = { BLK_OP_WRITE, BLK_OP_READ };
+
+#define NUM_SIZES (sizeof(block_sizes) / sizeof(block_sizes[0]))
+#define NUM_DEPTHS (sizeof(queue_depths) / sizeof(queue_depths[0]))
+#define NUM_OPS (sizeof(ops) / sizeof(ops[0]))
+
+/* Transfer about this much per run, bounded so small blocks finish and large ones average */
+#define BYTES_PER_RUN (8 << 20)
+#define MIN_IOS 256
+#define MAX_IOS 4096
+
+/* Low byte of a request id is its buffer index */
+#define ID_BUF(id) ((id) & 0xff)
+
+static struct {
+    unsigned index;
+    uint32_t op;
+    uint32_t bs;
+    uint32_t qd;
+    uint32_t total;
+    uint32_t issued;
+    uint32_t completed;
+    uint32_t errors;
+    uint64_t start;
+    uint64_t latency_cycles;
+} run;
+
+static enum { WAITING, RUNNING, DONE } state = WAITING;
+static uint64_t capacity;
+static uint32_t req_tail;
+static uint32_t resp_head;
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+/* One data buffer of run.bs bytes per outstanding request */
+static uint8_t free_bufs[BLK_QUEUE_SIZE];
+static unsigned free_count;
+static uint64_t submit_time[BLK_QUEUE_SIZE];
+
+static uint64_t next_random(void)
+{
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return rng_state >> 11;
+}
+
+static int start_run(unsigned index)
+{
+    unsigned op_idx = index % NUM_OPS;
+    unsigned qd_idx = (index / NUM_OPS) % NUM_DEPTHS;
+    unsigned bs_idx = index / (NUM_OPS * NUM_DEPTHS);
+
+    if (bs_idx >= NUM_SIZES) {
+        return 0;
+    }
+
+    run.index = index;
+    run.op = ops[op_idx];
+    run.bs = block_sizes[bs_idx];
+    run.qd = queue_depths[qd_idx];
+    run.total = BYTES_PER_RUN / run.bs;
+    if (run.total < MIN_IOS) {
+        run.total = MIN_IOS;
+    } else if (run.total > MAX_IOS) {
+        run.total = MAX_IOS;
+    }
+    run.issued = 0;
+    run.completed = 0;
+    run.errors = 0;
+    run.latency_cycles = 0;
+
+    free_count = 0;
+    for (unsigned i = 0; i < run.qd; i++) {
+        free_bufs[free_count++] = i;
+    }
+
+    run.start = timing_now();
+    return 1;
+}
+
+static void submit(void)
+{
+    uint32_t blocks = capacity / (run.bs / BLK_SECTOR_SIZE);
+    int submitted = 0;
+
+    while (run.issued < run.total && free_count > 0) {
+        unsigned buf = free_bufs[--free_count];
+        volatile struct blk_request *req = &QUEUE->req[req_tail % BLK_QUEUE_SIZE];
+
+        req->id = ((uint64_t)run.issued << 8) | buf;
+        req->sector = (next_random() % blocks) * (run.bs / BLK_SECTOR_SIZE);
+        req->data_offset = buf * run.bs;
+        req->len = run.bs;
+        req->op = run.op;
+
+        submit_time[buf] = timing_now();
+        req_tail++;
+        run.issued++;
+        submitted = 1;
+    }
+
+    if (submitted) {
+        pkt_ring_publish(&QUEUE->req_ring, req_tail);
+        microkit_notify(BLK_CH);
+    }
+}
+
+static void report(void)
+{
+    uint64_t ns = timing_ticks_to_ns(timing_now() - run.start);
+    uint64_t bytes = (uint64_t)run.completed * run.bs;
+
+    if (ns == 0) {
+        ns = 1;
+    }
+
+    microkit_dbg_puts("BLKBENCH|METRIC: op=");
+    microkit_dbg_puts(run.op == BLK_OP_READ ? "read" : "write");
+    dbg_put_kv("bs", run.bs);
+    dbg_put_kv("qd", run.qd);
+    dbg_put_kv("ios", run.completed);
+    dbg_put_kv("errors", run.errors);
+    dbg_put_kv("iops", (uint64_t)run.completed * 1000000000ULL / ns);
+    dbg_put_kv("mb_per_s", bytes * 1000ULL / ns);
+    dbg_put_kv("avg_lat_us", timing_ticks_to_ns(run.latency_cycles / run.completed) / 1000);
+    microkit_dbg_puts("\n");
+}
+
+static void reap(void)
+{
+    uint32_t tail = pkt_ring_tail(&QUEUE->resp_ring);
+    uint64_t now = timing_now();
+
+    while (resp_head != tail) {
+        volatile struct blk_response *resp = &QUEUE->resp[resp_head % BLK_QUEUE_SIZE];
+        unsigned buf = ID_BUF(resp->id);
+
+        if (resp->status != BLK_STATUS_OK) {
+            run.errors++;
+        }
+        run.latency_cycles += now - submit_time[buf];
+        free_bufs[free_count++] = buf;
+        run.completed++;
+        resp_head++;
+    }
+    pkt_ring_release(&QUEUE->resp_ring, resp_head);
+}
+
+static void begin(void)
+{
+    capacity = QUEUE->capacity_sectors;
+
+    microkit_dbg_puts("BLKBENCH|INFO: starting");
+    dbg_put_kv("capacity_sectors", capacity);
+    microkit_dbg_puts("\n");
+
+    /* The largest run needs qd buffers of bs bytes each in the data region */
+    uint32_t max_bs = block_sizes[NUM_SIZES - 1];
+    uint32_t max_qd = queue_depths[NUM_DEPTHS - 1];
+    if ((uint64_t)max_bs * max_qd > blk_data_size || max_qd > BLK_QUEUE_SIZE ||
+        capacity < max_bs / BLK_SECTOR_SIZE) {
+        microkit_dbg_puts("BLKBENCH|ERROR: data region or disk too small for the sweep\n");
+        state = DONE;
+        return;
+    }
+
+    /* Give written blocks recognisable contents */
+    for (uint64_t i = 0; i < blk_data_size; i += sizeof(uint64_t)) {
+        *(volatile uint64_t *)(blk_data_vaddr + i) = i;
+    }
+
+    state = RUNNING;
+    start_run(0);
+    submit();
+}
+
+void init(void)
+{
+    microkit_dbg_puts("BLKBENCH|INFO: waiting for block driver\n");
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != BLK_CH) {
+        microkit_dbg_puts("BLKBENCH|ERROR: notification on unexpected channel\n");
+        return;
+    }
+
+    if (state == WAITING) {
+        if (__atomic_load_n(&QUEUE->ready, __ATOMIC_ACQUIRE)) {
+            begin();
+        }
+        return;
+    }
+    if (state == DONE) {
+        return;
+    }
+
+    reap();
+
+    if (run.completed == run.total) {
+        report();
+        if (!start_run(run.index + 1)) {
+            microkit_dbg_puts("BLKBENCH|INFO: done\n");
+            state = DONE;
+            return;
+        }
+    }
+    submit();
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit virtio-blk Driver
+ *
+ * Serves one client over the blk_queue request/response rings. Each
+ * request becomes a three-descriptor chain (header, data, status); the
+ * data descriptor points straight into the client's data region, so the
+ * device DMAs to and from client buffers without a copy here. Requests
+ * are consumed in batches with one device kick, and responses are
+ * published in batches with one client notification.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "blk_queue.h"
+#include "dbg.h"
+#include "virtio.h"
+
+#define CLIENT_CH 0
+#define IRQ_CH 1
+
+#define REQUEST_QUEUE 0
+/* Three descriptors per in-flight request, BLK_QUEUE_SIZE requests */
+#define QUEUE_SIZE 256
+
+#define VIRTIO_BLK_F_FLUSH 9
+
+#define VIRTIO_BLK_T_IN    0
+#define VIRTIO_BLK_T_OUT   1
+#define VIRTIO_BLK_T_FLUSH 4
+
+struct virtio_blk_req_hdr {
+    uint32_t type;
+    uint32_t reserved;
+    uint64_t sector;
+};
+
+/* Page holding the transport; QEMU virt puts the disk on the last one, at offset 0xe00 */
+uintptr_t virtio_mmio_vaddr;
+#define REGS (virtio_mmio_vaddr + 0xe00)
+
+/* Virtqueue, then a page of request headers and status bytes */
+uintptr_t blk_dma_vaddr;
+uintptr_t blk_dma_paddr;
+#define HDR_OFFSET VIRTQ_REGION_SIZE
+#define STATUS_OFFSET (VIRTQ_REGION_SIZE + BLK_QUEUE_SIZE * sizeof(struct virtio_blk_req_hdr))
+
+uintptr_t blk_queue_vaddr;
+uintptr_t blk_data_paddr;
+uint64_t blk_data_size;
+
+#define QUEUE ((volatile struct blk_queue *)blk_queue_vaddr)
+
+static struct virtq vq;
+static uint64_t capacity;
+static int flush_supported;
+
+/* Client request id for each in-flight chain, indexed by slot (head descriptor / 3) */
+static uint64_t slot_id[BLK_QUEUE_SIZE];
+static uint16_t free_slots[BLK_QUEUE_SIZE];
+static unsigned free_count;
+
+static uint32_t req_head = 0;
+static uint32_t resp_tail = 0;
+
+static inline volatile struct virtio_blk_req_hdr *
+slot_hdr(unsigned slot)
+{
+    return (volatile struct virtio_blk_req_hdr *)(blk_dma_vaddr + HDR_OFFSET) + slot;
+}
+
+static inline volatile uint8_t *
+slot_status(unsigned slot)
+{
+    return (volatile uint8_t *)(blk_dma_vaddr + STATUS_OFFSET) + slot;
+}
+
+static inline int
+resp_full(void)
+{
+    return resp_tail - pkt_ring_head(&QUEUE->resp_ring) == BLK_QUEUE_SIZE;
+}
+
+static void
+respond(uint64_t id, uint32_t status)
+{
+    volatile struct blk_response *resp = &QUEUE->resp[resp_tail % BLK_QUEUE_SIZE];
+    resp->id = id;
+    resp->status = status;
+    resp_tail++;
+}
+
+static int
+request_valid(uint32_t op, uint64_t sector, uint32_t offset, uint32_t len)
+{
+    if (op == BLK_OP_FLUSH) {
+        return flush_supported;
+    }
+    if (op != BLK_OP_READ && op != BLK_OP_WRITE) {
+        return 0;
+    }
+    if (len == 0 || len % BLK_SECTOR_SIZE != 0) {
+        return 0;
+    }
+    if ((uint64_t)offset + len > blk_data_size) {
+        return 0;
+    }
+    return sector < capacity && len / BLK_SECTOR_SIZE <= capacity - sector;
+}
+
+/*
+ * Move requests from the client ring to the device while both a chain
+ * slot and (for rejects) a response slot are free. Returns the number of
+ * responses produced directly.
+ */
+static unsigned
+submit_requests(void)
+{
+    uint32_t req_tail = pkt_ring_tail(&QUEUE->req_ring);
+    unsigned submitted = 0;
+    unsigned rejected = 0;
+
+    while (req_head != req_tail && free_count > 0 && !resp_full()) {
+        volatile struct blk_request *req = &QUEUE->req[req_head % BLK_QUEUE_SIZE];
+        uint64_t id = req->id;
+        uint64_t sector = req->sector;
+        uint32_t offset = req->data_offset;
+        uint32_t len = req->len;
+        uint32_t op = req->op;
+        req_head++;
+
+        if (!request_valid(op, sector, offset, len)) {
+            respond(id, op == BLK_OP_FLUSH ? BLK_STATUS_UNSUPPORTED : BLK_STATUS_INVALID);
+            rejected++;
+            continue;
+        }
+
+        unsigned slot = free_slots[--free_count];
+        uint16_t d = slot * 3;
+        slot_id[slot] = id;
+
+        volatile struct virtio_blk_req_hdr *hdr = slot_hdr(slot);
+        hdr->type = op == BLK_OP_READ ? VIRTIO_BLK_T_IN : op == BLK_OP_WRITE ? VIRTIO_BLK_T_OUT : VIRTIO_BLK_T_FLUSH;
+        hdr->reserved = 0;
+        hdr->sector = op == BLK_OP_FLUSH ? 0 : sector;
+        *slot_status(slot) = 0xff;
+
+        vq.desc[d].addr = blk_dma_paddr + HDR_OFFSET + slot * sizeof(struct virtio_blk_req_hdr);
+        vq.desc[d].len = sizeof(struct virtio_blk_req_hdr);
+        vq.desc[d].flags = VIRTQ_DESC_F_NEXT;
+
+        if (op == BLK_OP_FLUSH) {
+            vq.desc[d].next = d + 2;
+        } else {
+            vq.desc[d].next = d + 1;
+            vq.desc[d + 1].addr = blk_data_paddr + offset;
+            vq.desc[d + 1].len = len;
+            vq.desc[d + 1].flags = VIRTQ_DESC_F_NEXT | (op == BLK_OP_READ ? VIRTQ_DESC_F_WRITE : 0);
+            vq.desc[d + 1].next = d + 2;
+        }
+
+        vq.desc[d + 2].addr = blk_dma_paddr + STATUS_OFFSET + slot;
+        vq.desc[d + 2].len = 1;
+        vq.desc[d + 2].flags = VIRTQ_DESC_F_WRITE;
+
+        virtq_push(&vq, d);
+        submitted++;
+    }
+
+    pkt_ring_release(&QUEUE->req_ring, req_head);
+    if (submitted) {
+        virtq_kick(REGS, REQUEST_QUEUE, &vq);
+    }
+    return rejected;
+}
+
+static unsigned
+complete_requests(void)
+{
+    struct virtq_used_elem elem;
+    unsigned completed = 0;
+
+    while (!resp_full() && virtq_pop_used(&vq, &elem)) {
+        unsigned slot = elem.id / 3;
+        uint8_t status = *slot_status(slot);
+        respond(slot_id[slot], status == 0 ? BLK_STATUS_OK :
+                               status == 2 ? BLK_STATUS_UNSUPPORTED : BLK_STATUS_IOERR);
+        free_slots[free_count++] = slot;
+        completed++;
+    }
+    return completed;
+}
+
+static void
+process(void)
+{
+    unsigned responses = complete_requests();
+    responses += submit_requests();
+
+    if (responses) {
+        pkt_ring_publish(&QUEUE->resp_ring, resp_tail);
+        microkit_notify(CLIENT_CH);
+    }
+}
+
+void
+init(void)
+{
+    microkit_dbg_puts("BLK|INFO: virtio-blk driver init\n");
+
+    int64_t features = virtio_mmio_negotiate(REGS, VIRTIO_DEVICE_ID_BLOCK, 1u << VIRTIO_BLK_F_FLUSH);
+    if (features < 0) {
+        microkit_dbg_puts("BLK|ERROR: no modern virtio-blk device (is virtio-mmio.force-legacy=false set?)\n");
+        return;
+    }
+    flush_supported = (features & (1u << VIRTIO_BLK_F_FLUSH)) != 0;
+
+    if (virtio_mmio_queue_setup(REGS, REQUEST_QUEUE, &vq, blk_dma_vaddr, blk_dma_paddr, QUEUE_SIZE)) {
+        microkit_dbg_puts("BLK|ERROR: virtqueue setup failed\n");
+        virtio_write32(REGS, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+        return;
+    }
+
+    for (unsigned i = 0; i < BLK_QUEUE_SIZE; i++) {
+        free_slots[i] = BLK_QUEUE_SIZE - 1 - i;
+    }
+    free_count = BLK_QUEUE_SIZE;
+
+    capacity = virtio_read32(REGS, VIRTIO_MMIO_CONFIG) |
+               ((uint64_t)virtio_read32(REGS, VIRTIO_MMIO_CONFIG + 4) << 32);
+
+    virtio_write32(REGS, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER |
+                   VIRTIO_STATUS_FEATURES_OK | VIRTIO_STATUS_DRIVER_OK);
+
+    microkit_dbg_puts("BLK|INFO:");
+    dbg_put_kv("capacity_sectors", capacity);
+    dbg_put_kv("flush", flush_supported);
+    microkit_dbg_puts("\n");
+
+    QUEUE->capacity_sectors = capacity;
+    __atomic_store_n(&QUEUE->ready, 1, __ATOMIC_RELEASE);
+    microkit_notify(CLIENT_CH);
+}
+
+void
+notified(microkit_channel ch)
+{
+    switch (ch) {
+        case IRQ_CH: {
+            uint32_t status = virtio_read32(REGS, VIRTIO_MMIO_INTERRUPT_STATUS);
+            virtio_write32(REGS, VIRTIO_MMIO_INTERRUPT_ACK, status);
+            process();
+            microkit_irq_ack(ch);
+            break;
+        }
+
+        case CLIENT_CH:
+            process();
+            break;
+
+        default:
+            microkit_dbg_puts("BLK|ERROR: notification on unexpected channel\n");
+            break;
+    }
+}
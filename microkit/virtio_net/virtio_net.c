@@ -0,0 +1,330 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit virtio-net Driver
+ *
+ * Stands in for the ethernet example's FEC driver (eth.c) on QEMU virt.
+ * It speaks the same protocol to pass: received frames are copied into
+ * the output region's 2 KiB slots and published on its pkt_ring, and
+ * frames published on the input ring are transmitted. One notification
+ * per batch in each direction.
+ *
+ * Both eth PDs run this program; VIRTIO_NET_SLOT (set per ELF by the
+ * Makefile) picks the virtio-mmio transport within the mapped page.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "memops.h"
+#include "pkt_ring.h"
+#include "virtio.h"
+
+#define OUTPUT_CH 1 /* output from this PD -- becomes input for peer */
+#define INPUT_CH 2 /* input to this PD -- comes from peer output */
+#define IRQ_CH 3
+
+/* Same slot layout as eth.c / pass.c */
+#define BUFFER_MAX 1024
+#define BUFFER_SIZE (2 * 1024)
+#define DATA_OFFSET 64
+
+#define RX_QUEUE 0
+#define TX_QUEUE 1
+#define QUEUE_SIZE 128
+
+#define VIRTIO_NET_F_MAC 5
+
+/* With VIRTIO_F_VERSION_1 the header always includes num_buffers */
+struct virtio_net_hdr {
+    uint8_t flags;
+    uint8_t gso_type;
+    uint16_t hdr_len;
+    uint16_t gso_size;
+    uint16_t csum_start;
+    uint16_t csum_offset;
+    uint16_t num_buffers;
+};
+
+#define PACKET_BUFFER_SIZE (2 * 1024)
+#define RX_BUFFER(i) (packet_buffer_vaddr + (i) * PACKET_BUFFER_SIZE)
+#define TX_BUFFER(i) (packet_buffer_vaddr + (QUEUE_SIZE + (i)) * PACKET_BUFFER_SIZE)
+
+/* 4 KiB page holding the virtio-mmio transports; ours is VIRTIO_NET_SLOT from the top */
+uintptr_t virtio_mmio_vaddr;
+/* Two VIRTQ_REGION_SIZE areas, RX then TX */
+uintptr_t virtq_vaddr;
+uintptr_t virtq_paddr;
+/* QUEUE_SIZE RX buffers followed by QUEUE_SIZE TX buffers */
+uintptr_t packet_buffer_vaddr;
+uintptr_t packet_buffer_paddr;
+
+uint64_t output_buffer_vaddr;
+uint64_t input_buffer_vaddr;
+uint64_t output_ring_vaddr;
+uint64_t input_ring_vaddr;
+
+#define OUTPUT_BUFFER output_buffer_vaddr
+#define INPUT_BUFFER input_buffer_vaddr
+#define OUTPUT_RING ((volatile struct pkt_ring *)(uintptr_t)output_ring_vaddr)
+#define INPUT_RING ((volatile struct pkt_ring *)(uintptr_t)input_ring_vaddr)
+
+#ifndef VIRTIO_NET_SLOT
+#define VIRTIO_NET_SLOT 0
+#endif
+/* QEMU virt fills transports downwards from 0x0a003e00: slot N is the (N+1)th -device in qemu_args */
+#define REGS (virtio_mmio_vaddr + 0xe00 - VIRTIO_NET_SLOT * 0x200)
+
+struct buffer_descriptor {
+    uint16_t data_length;
+};
+
+static struct virtq rx_vq;
+static struct virtq tx_vq;
+
+/* Free TX descriptor ids; each TX buffer has exactly one descriptor */
+static uint16_t tx_free[QUEUE_SIZE];
+static unsigned tx_free_count;
+
+static uint32_t output_tail = 0;
+static uint32_t input_head = 0;
+
+static uint64_t rx_packets = 0;
+static uint64_t rx_dropped = 0;
+static uint64_t tx_packets = 0;
+static uint64_t tx_dropped = 0;
+
+/* Print counters every this many received packets */
+#define STATS_INTERVAL (1 << 16)
+
+static void
+print_stats(void)
+{
+    microkit_dbg_puts("NET|METRIC: pd=");
+    microkit_dbg_puts(microkit_name);
+    dbg_put_kv("rx_packets", rx_packets);
+    dbg_put_kv("rx_dropped", rx_dropped);
+    dbg_put_kv("tx_packets", tx_packets);
+    dbg_put_kv("tx_dropped", tx_dropped);
+    microkit_dbg_puts("\n");
+}
+
+static void
+rx_refill(uint16_t id)
+{
+    rx_vq.desc[id].addr = packet_buffer_paddr + id * PACKET_BUFFER_SIZE;
+    rx_vq.desc[id].len = PACKET_BUFFER_SIZE;
+    rx_vq.desc[id].flags = VIRTQ_DESC_F_WRITE;
+    virtq_push(&rx_vq, id);
+}
+
+static void
+handle_rx(void)
+{
+    struct virtq_used_elem elem;
+    int produced = 0;
+    int refilled = 0;
+    uint64_t seen = rx_packets + rx_dropped;
+
+    while (virtq_pop_used(&rx_vq, &elem)) {
+        uint16_t id = elem.id;
+        uint32_t length = elem.len - sizeof(struct virtio_net_hdr);
+        void *packet = (void *)(RX_BUFFER(id) + sizeof(struct virtio_net_hdr));
+
+        unsigned slot = output_tail % BUFFER_MAX;
+        volatile struct buffer_descriptor *bd = (void *)(uintptr_t)(OUTPUT_BUFFER + (BUFFER_SIZE * slot));
+        volatile void *output_packet = (void *)(uintptr_t)(OUTPUT_BUFFER + (BUFFER_SIZE * slot) + DATA_OFFSET);
+        if (elem.len <= sizeof(struct virtio_net_hdr) || length > BUFFER_SIZE - DATA_OFFSET) {
+            rx_dropped++;
+        } else if (output_tail - pkt_ring_head(OUTPUT_RING) == BUFFER_MAX) {
+            /* pass is behind; drop rather than stall the device */
+            rx_dropped++;
+        } else {
+            bd->data_length = length;
+            memcpy((void *)output_packet, packet, length);
+            output_tail++;
+            rx_packets++;
+            produced = 1;
+        }
+
+        rx_refill(id);
+        refilled = 1;
+    }
+
+    if (refilled) {
+        virtq_kick(REGS, RX_QUEUE, &rx_vq);
+    }
+    if (produced) {
+        pkt_ring_publish(OUTPUT_RING, output_tail);
+        microkit_notify(OUTPUT_CH);
+    }
+
+    if ((seen / STATS_INTERVAL) != ((rx_packets + rx_dropped) / STATS_INTERVAL)) {
+        print_stats();
+    }
+}
+
+static void
+tx_reclaim(void)
+{
+    struct virtq_used_elem elem;
+
+    while (virtq_pop_used(&tx_vq, &elem)) {
+        tx_free[tx_free_count++] = elem.id;
+    }
+}
+
+/*
+ * Transmit as much of the input ring as there are free TX buffers for.
+ * If we run out, leave the rest on the ring and ask the device for a
+ * completion interrupt so we come back for it; otherwise completions are
+ * reaped lazily on the next batch.
+ */
+static void
+handle_tx(void)
+{
+    uint32_t input_tail = pkt_ring_tail(INPUT_RING);
+    uint32_t start = input_head;
+
+    for (;;) {
+        tx_reclaim();
+
+        while (input_head != input_tail && tx_free_count > 0) {
+            unsigned slot = input_head % BUFFER_MAX;
+            volatile struct buffer_descriptor *bd = (void *)(uintptr_t)(INPUT_BUFFER + (BUFFER_SIZE * slot));
+            volatile void *pkt = (void *)(uintptr_t)(INPUT_BUFFER + (BUFFER_SIZE * slot) + DATA_OFFSET);
+            uint16_t length = bd->data_length;
+            if (length > BUFFER_SIZE - DATA_OFFSET) {
+                /* Longer than the slot; pass wrote a bad descriptor */
+                input_head++;
+                tx_dropped++;
+                continue;
+            }
+            uint16_t id = tx_free[--tx_free_count];
+
+            struct virtio_net_hdr *hdr = (void *)TX_BUFFER(id);
+            memset(hdr, 0, sizeof(*hdr));
+            memcpy(hdr + 1, (void *)pkt, length);
+
+            tx_vq.desc[id].addr = packet_buffer_paddr + (QUEUE_SIZE + id) * PACKET_BUFFER_SIZE;
+            tx_vq.desc[id].len = sizeof(*hdr) + length;
+            tx_vq.desc[id].flags = 0;
+            virtq_push(&tx_vq, id);
+
+            input_head++;
+            tx_packets++;
+        }
+
+        if (input_head == input_tail) {
+            tx_vq.avail->flags = VIRTQ_AVAIL_F_NO_INTERRUPT;
+            break;
+        }
+
+        /* Out of buffers. Re-check after enabling the interrupt in case the device already caught up. */
+        tx_vq.avail->flags = 0;
+        virtio_mb();
+        if (tx_vq.last_used == tx_vq.used->idx) {
+            break;
+        }
+    }
+
+    if (input_head != start) {
+        virtq_kick(REGS, TX_QUEUE, &tx_vq);
+        pkt_ring_release(INPUT_RING, input_head);
+        if (INPUT_RING->notify_on_release) {
+            microkit_notify(INPUT_CH);
+        }
+    }
+}
+
+static void
+handle_irq(void)
+{
+    uint32_t status = virtio_read32(REGS, VIRTIO_MMIO_INTERRUPT_STATUS);
+    virtio_write32(REGS, VIRTIO_MMIO_INTERRUPT_ACK, status);
+
+    if (status & VIRTIO_INT_USED_RING) {
+        handle_rx();
+        handle_tx();
+    }
+}
+
+static void
+print_mac(void)
+{
+    microkit_dbg_puts("MAC: ");
+    for (int i = 0; i < 6; i++) {
+        uint8_t b = *(volatile uint8_t *)(REGS + VIRTIO_MMIO_CONFIG + i);
+        microkit_dbg_putc("0123456789abcdef"[b >> 4]);
+        microkit_dbg_putc("0123456789abcdef"[b & 0xf]);
+        if (i != 5) {
+            microkit_dbg_putc(':');
+        }
+    }
+    microkit_dbg_puts("\n");
+}
+
+void
+init(void)
+{
+    microkit_dbg_puts(microkit_name);
+    microkit_dbg_puts(": virtio-net driver init\n");
+
+    int64_t features = virtio_mmio_negotiate(REGS, VIRTIO_DEVICE_ID_NET, 1u << VIRTIO_NET_F_MAC);
+    if (features < 0) {
+        microkit_dbg_puts(microkit_name);
+        microkit_dbg_puts(": no modern virtio-net device (is virtio-mmio.force-legacy=false set?)\n");
+        return;
+    }
+
+    if (virtio_mmio_queue_setup(REGS, RX_QUEUE, &rx_vq, virtq_vaddr, virtq_paddr, QUEUE_SIZE) ||
+        virtio_mmio_queue_setup(REGS, TX_QUEUE, &tx_vq, virtq_vaddr + VIRTQ_REGION_SIZE,
+                                virtq_paddr + VIRTQ_REGION_SIZE, QUEUE_SIZE)) {
+        microkit_dbg_puts(microkit_name);
+        microkit_dbg_puts(": virtqueue setup failed\n");
+        virtio_write32(REGS, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_FAILED);
+        return;
+    }
+
+    for (uint16_t i = 0; i < QUEUE_SIZE; i++) {
+        rx_refill(i);
+        tx_free[i] = i;
+    }
+    tx_free_count = QUEUE_SIZE;
+    tx_vq.avail->flags = VIRTQ_AVAIL_F_NO_INTERRUPT;
+
+    virtio_write32(REGS, VIRTIO_MMIO_STATUS, VIRTIO_STATUS_ACKNOWLEDGE | VIRTIO_STATUS_DRIVER |
+                   VIRTIO_STATUS_FEATURES_OK | VIRTIO_STATUS_DRIVER_OK);
+    virtq_kick(REGS, RX_QUEUE, &rx_vq);
+
+    microkit_dbg_puts(microkit_name);
+    microkit_dbg_puts(": ");
+    if (features & (1u << VIRTIO_NET_F_MAC)) {
+        print_mac();
+    } else {
+        microkit_dbg_puts("no MAC from device\n");
+    }
+}
+
+void
+notified(microkit_channel ch)
+{
+    switch (ch) {
+        case IRQ_CH:
+            handle_irq();
+            microkit_irq_ack(ch);
+            break;
+
+        case INPUT_CH:
+            handle_tx();
+            break;
+
+        case OUTPUT_CH:
+            break;
+
+        default:
+            microkit_dbg_puts(microkit_name);
+            microkit_dbg_puts(": received notification on unexpected channel\n");
+            break;
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Watchdog Demo - Load
+ *
+ * Spins forever. How much CPU that takes from the workers depends on the
+ * priority and budget it is built with (see the Makefile); by default it
+ * only uses idle time.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+
+void init(void)
+{
+    for (;;) {
+        __asm__ volatile("" ::: "memory");
+    }
+}
+
+void notified(microkit_channel ch)
+{
+}
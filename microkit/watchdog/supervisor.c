@@ -0,0 +1,72 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Watchdog Demo - Supervisor
+ *
+ * Parent of the workers. A hung worker never faults, so it is the
+ * watchdog that tells the supervisor, by marking the worker dead in the
+ * shared page and notifying. The supervisor then stops the worker and
+ * restarts it on a fresh stack, the same as after a real fault, which
+ * comes to fault() here.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "pd_snapshot.h"
+#include "watchdog.h"
+
+#define WATCHDOG_CH 0
+
+/* Worker w is child WORKER_ID_BASE + w */
+#define WORKER_ID_BASE 1
+
+uintptr_t shared_vaddr;
+#define SHARED ((volatile struct watchdog_shared *)shared_vaddr)
+
+static void restart(unsigned w)
+{
+    /* Suspend first so a worker that is spinning or blocked gets restarted too */
+    microkit_pd_stop(WORKER_ID_BASE + w);
+    SHARED->hung[w] = 0;
+    pd_snapshot_restart(WORKER_ID_BASE + w);
+    SHARED->restarts[w]++;
+}
+
+void init(void)
+{
+    microkit_dbg_puts("SUPERVISOR|INFO: Supervising workers\n");
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != WATCHDOG_CH) {
+        microkit_dbg_puts("SUPERVISOR|ERROR: notification on unexpected channel\n");
+        return;
+    }
+
+    for (unsigned w = 0; w < NUM_WORKERS; w++) {
+        if (SHARED->dead[w]) {
+            restart(w);
+            /* Only now may the watchdog take its heartbeats again */
+            SHARED->dead[w] = 0;
+        }
+    }
+}
+
+seL4_Bool fault(microkit_child child, microkit_msginfo msginfo, microkit_msginfo *reply_msginfo)
+{
+    if (child < WORKER_ID_BASE || child >= WORKER_ID_BASE + NUM_WORKERS) {
+        microkit_dbg_puts("SUPERVISOR|ERROR: fault from unexpected child, stopping it\n");
+        microkit_pd_stop(child);
+        return seL4_False;
+    }
+
+    microkit_dbg_puts("SUPERVISOR|ERROR: worker faulted (fault label=");
+    dbg_put_u64(microkit_msginfo_get_label(msginfo));
+    microkit_dbg_puts("), restarting it\n");
+    restart(child - WORKER_ID_BASE);
+
+    /* Restarted explicitly, so no reply */
+    return seL4_False;
+}
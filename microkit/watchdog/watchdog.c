@@ -0,0 +1,201 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Watchdog Demo - Watchdog
+ *
+ * Expects a heartbeat notification from every worker each HEARTBEAT_US.
+ * A worker registers with its first heartbeat. The watchdog checks once
+ * per period, on its own periodic timeout from the timer PD, and a worker
+ * whose heartbeats stop for MISSED_PERIODS checks in a row is declared
+ * dead: the watchdog marks it in the shared page and notifies the
+ * supervisor, which restarts it. The worker registers again with its
+ * first heartbeat after the restart.
+ *
+ * Workers hang on purpose and say so in the shared page, so each
+ * declaration is either a detection, timed from the start of the hang,
+ * or a false positive: a worker that was only late, for instance because
+ * the load PD held the CPU. After RUN_MS the watchdog reports both.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "dbg.h"
+#include "timing.h"
+#include "stats.h"
+#include "timer_client.h"
+#include "watchdog.h"
+
+#define TIMER_CH 0
+/* Worker w sends its heartbeats on channel WORKER_CH_BASE + w */
+#define WORKER_CH_BASE 1
+#define SUPERVISOR_CH 4
+
+#ifndef HEARTBEAT_US
+#define HEARTBEAT_US 1000
+#endif
+
+#ifndef MISSED_PERIODS
+#define MISSED_PERIODS 3
+#endif
+
+#ifndef RUN_MS
+#define RUN_MS 10000
+#endif
+
+/* Only for the report */
+#ifndef LOAD_PRIORITY
+#define LOAD_PRIORITY 0
+#endif
+#ifndef LOAD_BUDGET
+#define LOAD_BUDGET 0
+#endif
+#ifndef LOAD_PERIOD
+#define LOAD_PERIOD 0
+#endif
+
+#define MAX_DETECTIONS 256
+
+uintptr_t shared_vaddr;
+#define SHARED ((volatile struct watchdog_shared *)shared_vaddr)
+
+struct worker {
+    int registered;
+    uint64_t beats;
+    uint64_t seen;
+    unsigned missed;
+};
+
+static struct worker workers[NUM_WORKERS];
+
+static uint64_t freq;
+static uint64_t run_end;
+static int done;
+
+/* Worker-periods checked while registered; the false-positive rate is per these */
+static uint64_t periods;
+static uint64_t false_positives;
+static uint64_t detected;
+static uint32_t detections[MAX_DETECTIONS];
+static unsigned num_detections;
+
+static void report(void)
+{
+    uint64_t hangs = 0, restarts = 0;
+    unsigned n = num_detections;
+
+    for (unsigned w = 0; w < NUM_WORKERS; w++) {
+        hangs += SHARED->hangs[w];
+        restarts += SHARED->restarts[w];
+    }
+
+    microkit_dbg_puts("WATCHDOG|METRIC: heartbeat_us=");
+    dbg_put_u64(HEARTBEAT_US);
+    dbg_put_kv("missed_periods", MISSED_PERIODS);
+    dbg_put_kv("load_priority", LOAD_PRIORITY);
+    dbg_put_kv("load_budget_us", LOAD_BUDGET);
+    dbg_put_kv("load_period_us", LOAD_PERIOD);
+    dbg_put_kv("periods", periods);
+    dbg_put_kv("hangs", hangs);
+    dbg_put_kv("detected", detected);
+    dbg_put_kv("false_positives", false_positives);
+    dbg_put_kv("fp_per_million_periods", periods ? false_positives * 1000000 / periods : 0);
+    dbg_put_kv("restarts", restarts);
+    microkit_dbg_puts("\n");
+
+    if (n == 0) {
+        return;
+    }
+    struct stats_summary s = stats_summarize_u32(detections, n);
+    microkit_dbg_puts("WATCHDOG|METRIC: kind=detection_latency");
+    dbg_put_kv("samples", n);
+    dbg_put_kv("min_us", timing_ticks_to_us(s.min));
+    dbg_put_kv("p50_us", timing_ticks_to_us(s.p50));
+    dbg_put_kv("p99_us", timing_ticks_to_us(s.p99));
+    dbg_put_kv("max_us", timing_ticks_to_us(s.max));
+    dbg_put_kv("avg_us", timing_ticks_to_us(s.avg));
+    microkit_dbg_puts("\n");
+}
+
+static void declare_dead(unsigned w, uint64_t now)
+{
+    if (SHARED->hung[w]) {
+        detected++;
+        if (num_detections < MAX_DETECTIONS) {
+            detections[num_detections++] = now - SHARED->hang_time[w];
+        }
+    } else {
+        false_positives++;
+    }
+
+    workers[w].registered = 0;
+    SHARED->dead[w] = 1;
+    microkit_notify(SUPERVISOR_CH);
+}
+
+static void check(void)
+{
+    uint64_t now = timing_now();
+
+    for (unsigned w = 0; w < NUM_WORKERS; w++) {
+        struct worker *wk = &workers[w];
+
+        if (!wk->registered) {
+            continue;
+        }
+        periods++;
+        if (wk->beats != wk->seen) {
+            wk->seen = wk->beats;
+            wk->missed = 0;
+        } else if (++wk->missed == MISSED_PERIODS) {
+            declare_dead(w, now);
+        }
+    }
+
+    if (now >= run_end) {
+        done = 1;
+        timer_cancel(TIMER_CH);
+        report();
+        microkit_dbg_puts("WATCHDOG|INFO: done\n");
+    }
+}
+
+static void heartbeat(unsigned w)
+{
+    struct worker *wk = &workers[w];
+
+    wk->beats++;
+    /* The first heartbeat, or the first since a restart, registers the worker */
+    if (!wk->registered && !SHARED->dead[w]) {
+        wk->registered = 1;
+        wk->seen = wk->beats;
+        wk->missed = 0;
+    }
+}
+
+void init(void)
+{
+    freq = timing_freq();
+    run_end = timing_now() + RUN_MS * freq / 1000;
+
+    microkit_dbg_puts("WATCHDOG|INFO: starting");
+    dbg_put_kv("heartbeat_us", HEARTBEAT_US);
+    dbg_put_kv("missed_periods", MISSED_PERIODS);
+    dbg_put_kv("run_ms", RUN_MS);
+    microkit_dbg_puts("\n");
+
+    timer_set_periodic(TIMER_CH, HEARTBEAT_US * NS_IN_US);
+}
+
+void notified(microkit_channel ch)
+{
+    if (done) {
+        return;
+    }
+    if (ch == TIMER_CH) {
+        check();
+    } else if (ch >= WORKER_CH_BASE && ch < WORKER_CH_BASE + NUM_WORKERS) {
+        heartbeat(ch - WORKER_CH_BASE);
+    } else {
+        microkit_dbg_puts("WATCHDOG|ERROR: notification on unexpected channel\n");
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2025
+ * Page shared by the watchdog demo PDs
+ *
+ * The watchdog marks a worker dead here and the supervisor clears the mark
+ * once it has restarted the worker. Workers record their own deliberate
+ * hangs so that the watchdog can tell a detection from a false positive
+ * and time it; that part is instrumentation, not something a real worker
+ * would need.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#pragma once
+
+#include <stdint.h>
+#include "timing.h"
+
+#define NUM_WORKERS 3
+
+enum hang_kind {
+    /* Spins without ever returning to the event loop */
+    HANG_SPIN,
+    /* Stops its timer and blocks in the event loop for good, like a deadlock */
+    HANG_BLOCK,
+    NUM_HANG_KINDS,
+};
+
+struct watchdog_shared {
+    /* Written by each worker: whether it is hanging on purpose, and since when */
+    uint64_t hung[NUM_WORKERS];
+    uint64_t hang_time[NUM_WORKERS];
+    uint64_t hangs[NUM_WORKERS];
+    /* Set by the watchdog, cleared by the supervisor after the restart */
+    uint64_t dead[NUM_WORKERS];
+    /* Written by the supervisor */
+    uint64_t restarts[NUM_WORKERS];
+};
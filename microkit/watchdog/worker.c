@@ -0,0 +1,93 @@
+/*
+ * Copyright 2025
+ * seL4 Microkit Watchdog Demo - Worker
+ *
+ * Built once per worker with its WORKER_ID. Every HEARTBEAT_US the timer
+ * PD wakes the worker, which does WORK_US of work and then sends the
+ * watchdog its heartbeat. After a random number of heartbeats, HANG_EVERY_MS
+ * worth on average, it hangs on purpose, alternately by spinning and by
+ * blocking (see watchdog.h), and stays hung until the supervisor
+ * restarts it.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+#include <stdint.h>
+#include <microkit.h>
+#include "timer_client.h"
+#include "watchdog.h"
+
+#define TIMER_CH 0
+#define WATCHDOG_CH 1
+
+#ifndef WORKER_ID
+#error "WORKER_ID must be defined"
+#endif
+
+#ifndef HEARTBEAT_US
+#define HEARTBEAT_US 1000
+#endif
+
+#ifndef WORK_US
+#define WORK_US 100
+#endif
+
+#ifndef HANG_EVERY_MS
+#define HANG_EVERY_MS 500
+#endif
+
+#define HANG_AFTER_BEATS (HANG_EVERY_MS * 1000ULL / HEARTBEAT_US)
+
+uintptr_t shared_vaddr;
+#define SHARED ((volatile struct watchdog_shared *)shared_vaddr)
+
+/* Survives restarts, so each boot draws a different hang time */
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL * (WORKER_ID + 1);
+static uint64_t beats_until_hang;
+static uint64_t work_ticks;
+
+static uint64_t random_beats(void)
+{
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return HANG_AFTER_BEATS / 2 + (rng_state >> 33) % (HANG_AFTER_BEATS + 1);
+}
+
+static void work(void)
+{
+    uint64_t end = timing_now() + work_ticks;
+    while (timing_now() < end);
+}
+
+static void hang(void)
+{
+    enum hang_kind kind = SHARED->hangs[WORKER_ID] % NUM_HANG_KINDS;
+
+    SHARED->hang_time[WORKER_ID] = timing_now();
+    SHARED->hung[WORKER_ID] = 1;
+    SHARED->hangs[WORKER_ID]++;
+
+    if (kind == HANG_SPIN) {
+        for (;;);
+    }
+    /* Back to the event loop with nothing left to wake us */
+    timer_cancel(TIMER_CH);
+}
+
+void init(void)
+{
+    work_ticks = WORK_US * timing_freq() / 1000000;
+    beats_until_hang = random_beats() + 1;
+    timer_set_periodic(TIMER_CH, HEARTBEAT_US * NS_IN_US);
+}
+
+void notified(microkit_channel ch)
+{
+    if (ch != TIMER_CH) {
+        return;
+    }
+
+    work();
+    microkit_notify(WATCHDOG_CH);
+    if (--beats_until_hang == 0) {
+        hang();
+    }
+}
@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""
+Break a Microkit system's startup down by boot phase
+Usage: ./boot_timing.py [app] [board] [config] [--runs N] [--timeout S] [--csv FILE]
+
+Boots the image with run.sh under a pseudo-terminal and timestamps every
+serial line as it arrives on the host, from QEMU launch. The loader,
+kernel and monitor each print a line as they start and finish, which
+splits the boot into:
+
+  qemu_start         QEMU launch to the first serial byte
+  loader             first byte to "LDR|INFO: jumping to kernel"
+  kernel             to "Booting all finished, dropped to user space"
+  monitor_bootstrap  to "MON|INFO: completed bootstrap invocations"
+  monitor_system     to "MON|INFO: completed system invocations", i.e. the
+                     system invocations listed in report.txt
+  pd_init            to the last BOOT|METRIC line, i.e. every PD's init()
+  time_to_service    QEMU launch to the last BOOT|METRIC line
+
+PDs instrumented with microkit/lib/boot_time.h print their own init()
+entry and exit on the guest counter, which starts at machine reset; those
+are reported per PD. The monitor only prints in debug builds, so release
+builds report fewer phases. Host timestamps include QEMU's emulation
+speed and the time to get the bytes through the pty; compare runs on the
+same host.
+"""
+
+import argparse
+import os
+import pty
+import re
+import select
+import signal
+import statistics
+import sys
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+# (phase that ends at the marker, marker)
+MARKERS = [
+    ('loader', 'LDR|INFO: jumping to kernel'),
+    ('kernel', 'Booting all finished, dropped to user space'),
+    ('monitor_bootstrap', 'MON|INFO: completed bootstrap invocations'),
+    ('monitor_system', 'MON|INFO: completed system invocations'),
+]
+
+BOOT_RE = re.compile(r'BOOT\|METRIC: pd=(\S+) init_entry_ns=(\d+) init_exit_ns=(\d+) init_ns=(\d+)')
+INVOCATIONS_RE = re.compile(r'MON\|INFO: Number of system invocations:\s*(?:0x)?([0-9a-fA-F]+)')
+
+
+def boot_once(app, board, config, timeout, idle, log_file):
+    """Boot once; return (phase ms dict, per-PD dict, system invocations)"""
+    launch = time.monotonic()
+    pid, fd = pty.fork()
+    if pid == 0:
+        os.execv(os.path.join(SCRIPT_DIR, 'run.sh'), ['run.sh', app, board, config])
+
+    first_byte = None
+    marks = {}
+    pds = {}
+    last_boot = None
+    invocations = None
+    buf = b''
+    deadline = launch + timeout
+
+    try:
+        while True:
+            now = time.monotonic()
+            if now >= deadline:
+                break
+            # Once every PD has reported, stop when the output goes quiet
+            wait = deadline - now
+            if last_boot is not None:
+                wait = min(wait, idle)
+            ready, _, _ = select.select([fd], [], [], wait)
+            if not ready:
+                if last_boot is not None:
+                    break
+                continue
+            try:
+                data = os.read(fd, 4096)
+            except OSError:
+                break
+            if not data:
+                break
+            now = time.monotonic()
+            if first_byte is None:
+                first_byte = now
+            buf += data
+            while b'\n' in buf:
+                raw, buf = buf.split(b'\n', 1)
+                line = raw.decode('utf-8', errors='replace').rstrip('\r')
+                if log_file:
+                    log_file.write(f"{(now - launch) * 1000:10.3f} {line}\n")
+                for phase, marker in MARKERS:
+                    if marker in line and phase not in marks:
+                        marks[phase] = now
+                m = INVOCATIONS_RE.search(line)
+                if m:
+                    invocations = int(m.group(1), 16 if '0x' in line else 10)
+                m = BOOT_RE.search(line)
+                if m:
+                    pd, entry, exit_, init = m.groups()
+                    pds[pd] = {'entry_ms': int(entry) / 1e6, 'exit_ms': int(exit_) / 1e6,
+                               'init_ms': int(init) / 1e6}
+                    last_boot = now
+    finally:
+        try:
+            os.killpg(pid, signal.SIGTERM)
+        except ProcessLookupError:
+            pass
+        os.waitpid(pid, 0)
+        os.close(fd)
+
+    phases = {}
+    if first_byte is None:
+        return phases, pds, invocations
+    phases['qemu_start'] = (first_byte - launch) * 1000
+    prev = first_byte
+    for phase, _ in MARKERS:
+        if phase in marks:
+            phases[phase] = (marks[phase] - prev) * 1000
+            prev = marks[phase]
+    if last_boot is not None:
+        phases['pd_init'] = (last_boot - prev) * 1000
+        phases['time_to_service'] = (last_boot - launch) * 1000
+    return phases, pds, invocations
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Per-phase boot time of a Microkit system in QEMU')
+    parser.add_argument('app', nargs='?', default='ipc_demo')
+    parser.add_argument('board', nargs='?', default='qemu_virt_aarch64')
+    parser.add_argument('config', nargs='?', default='debug')
+    parser.add_argument('--runs', type=int, default=1, help='boots to run; medians are reported')
+    parser.add_argument('--timeout', type=float, default=30.0, help='seconds to wait for each boot')
+    parser.add_argument('--idle', type=float, default=2.0,
+                        help='seconds of silence after a BOOT line that end a boot')
+    parser.add_argument('--csv', help='append one row per boot and phase to this file')
+    parser.add_argument('--log', help='write the timestamped serial output to this file')
+    args = parser.parse_args()
+
+    log_file = open(args.log, 'w') if args.log else None
+    results = []
+    for run in range(args.runs):
+        phases, pds, invocations = boot_once(args.app, args.board, args.config,
+                                             args.timeout, args.idle, log_file)
+        if not phases:
+            print(f"Error: no serial output from boot {run + 1}", file=sys.stderr)
+            return 1
+        if 'time_to_service' not in phases:
+            print(f"Warning: boot {run + 1} printed no BOOT|METRIC lines; "
+                  f"is {args.app} instrumented with boot_time.h?", file=sys.stderr)
+        results.append((phases, pds, invocations))
+    if log_file:
+        log_file.close()
+
+    order = ['qemu_start'] + [p for p, _ in MARKERS] + ['pd_init', 'time_to_service']
+    for phase in order:
+        values = [r[0][phase] for r in results if phase in r[0]]
+        if values:
+            print(f"BOOTTIME|METRIC: app={args.app} board={args.board} config={args.config} "
+                  f"phase={phase} runs={len(values)} median_ms={statistics.median(values):.3f} "
+                  f"min_ms={min(values):.3f} max_ms={max(values):.3f}")
+
+    invocations = next((r[2] for r in results if r[2] is not None), None)
+    if invocations is not None:
+        print(f"BOOTTIME|INFO: system invocations={invocations}")
+
+    pd_names = sorted({pd for r in results for pd in r[1]},
+                      key=lambda pd: statistics.median(r[1][pd]['entry_ms'] for r in results if pd in r[1]))
+    for pd in pd_names:
+        samples = [r[1][pd] for r in results if pd in r[1]]
+        entry = statistics.median(s['entry_ms'] for s in samples)
+        init = statistics.median(s['init_ms'] for s in samples)
+        print(f"BOOTTIME|METRIC: app={args.app} board={args.board} config={args.config} "
+              f"phase=init pd={pd} runs={len(samples)} entry_since_reset_ms={entry:.3f} init_ms={init:.3f}")
+
+    if args.csv:
+        new = not os.path.exists(args.csv)
+        with open(args.csv, 'a') as f:
+            if new:
+                f.write('timestamp,app,board,config,run,phase,pd,ms\n')
+            stamp = int(time.time())
+            for run, (phases, pds, _) in enumerate(results, 1):
+                for phase in order:
+                    if phase in phases:
+                        f.write(f"{stamp},{args.app},{args.board},{args.config},{run},{phase},,{phases[phase]:.3f}\n")
+                for pd, s in pds.items():
+                    f.write(f"{stamp},{args.app},{args.board},{args.config},{run},init,{pd},{s['init_ms']:.3f}\n")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -26,6 +26,20 @@ if [ ! -f "$IMAGE_FILE" ]; then
     exit 1
 fi
 
+# Extra QEMU arguments an application needs (devices, netdevs, disks), if any.
+# $BUILD_DIR in the file expands to this build's output directory.
+QEMU_EXTRA_ARGS=()
+QEMU_ARGS_FILE="$PROJECT_ROOT/microkit/$APP_NAME/qemu_args"
+if [ -f "$QEMU_ARGS_FILE" ]; then
+    while read -r line; do
+        case "$line" in
+            ""|"#"*) continue ;;
+        esac
+        line="${line//\$BUILD_DIR/$BUILD_DIR}"
+        QEMU_EXTRA_ARGS+=($line)
+    done < "$QEMU_ARGS_FILE"
+fi
+
 echo "Capturing logs for $APP_NAME on $BOARD"
 echo "Image: $IMAGE_FILE"
 echo "Output file: $OUTPUT_FILE"
@@ -46,15 +60,17 @@ case "$BOARD" in
             -serial mon:stdio \
             -m 2048M \
             -kernel "$IMAGE_FILE" \
-            -no-reboot 2>&1 | tee "$OUTPUT_FILE"
+            -no-reboot \
+            "${QEMU_EXTRA_ARGS[@]}" 2>&1 | tee "$OUTPUT_FILE"
         ;;
     qemu_virt_riscv64)
         qemu-system-riscv64 -machine virt \
             -cpu rv64 \
             -nographic \
             -serial mon:stdio \
-            -m size=1024M \
-            -kernel "$IMAGE_FILE" 2>&1 | tee "$OUTPUT_FILE"
+            -m size=2G \
+            -kernel "$IMAGE_FILE" \
+            "${QEMU_EXTRA_ARGS[@]}" 2>&1 | tee "$OUTPUT_FILE"
         ;;
     *)
         echo "Error: Unsupported board: $BOARD"
@@ -0,0 +1,59 @@
+#!/bin/bash
+#
+# Compare ipc_demo's IPC cost on AArch64 and RISC-V
+# Usage: ./compare_isa.sh [iterations] [config]
+#
+# Runs run_metrics.sh for ipc_demo on qemu_virt_aarch64 and then on
+# qemu_virt_riscv64, keeps each board's results.csv and prints the mean
+# of both latency columns side by side. Both are QEMU (TCG) numbers:
+# they compare the kernel paths as emulated, not real cores.
+#
+
+set -e
+
+export PATH="/usr/bin:/bin:/usr/local/bin:$PATH"
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+ITERATIONS="${1:-10}"
+CONFIG="${2:-debug}"
+BOARDS="qemu_virt_aarch64 qemu_virt_riscv64"
+
+COMPARE_DIR="$PROJECT_ROOT/out/isa/$(date +%Y%m%d-%H%M)"
+mkdir -p "$COMPARE_DIR"
+
+echo "Comparing ipc_demo IPC cost across architectures"
+echo "Iterations: $ITERATIONS"
+echo "Config: $CONFIG"
+echo "Results directory: $COMPARE_DIR"
+echo ""
+
+for BOARD in $BOARDS; do
+    echo "Running $BOARD..."
+    "$SCRIPT_DIR/run_metrics.sh" ipc_demo "$BOARD" "$CONFIG" "$ITERATIONS"
+
+    # run_metrics.sh writes to a directory per minute; copy before the next board reuses it
+    LATEST_RUN=$(ls -td "$PROJECT_ROOT/out/metrics"/*/ 2>/dev/null | head -1)
+    if [ -z "$LATEST_RUN" ] || [ ! -f "$LATEST_RUN/results.csv" ]; then
+        echo "ERROR: no results for $BOARD"
+        exit 1
+    fi
+    cp "$LATEST_RUN/results.csv" "$COMPARE_DIR/$BOARD.csv"
+    echo ""
+done
+
+SUMMARY="$COMPARE_DIR/summary.csv"
+echo "board,runs,first_call_avg_ns,ppcall_avg_ns" > "$SUMMARY"
+for BOARD in $BOARDS; do
+    awk -F',' -v board="$BOARD" '
+        NR > 1 { n++; first += $2; if ($4 != "") { pn++; pp += $4 } }
+        END {
+            printf "%s,%d,%d,%s\n", board, n, n ? first / n : 0, pn ? int(pp / pn) : ""
+        }' "$COMPARE_DIR/$BOARD.csv" >> "$SUMMARY"
+done
+
+echo "Summary (first_call is the demo's single timed call, ppcall the null-call loop):"
+column -t -s',' "$SUMMARY" 2>/dev/null || cat "$SUMMARY"
+echo ""
+echo "Summary saved to: $SUMMARY"
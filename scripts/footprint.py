@@ -0,0 +1,360 @@
+#!/usr/bin/env python3
+"""
+Per-PD memory footprint of a Microkit build, and the change between two builds
+Usage: ./footprint.py report BUILD_DIR [--sdf FILE] [--csv FILE] [--hwm LOG]
+       ./footprint.py diff OLD NEW [--old-sdf FILE] [--new-sdf FILE] [--threshold PCT]
+Both also take --sdf, --board, --config and --sdk after the command.
+
+BUILD_DIR is a build output directory such as out/ipc_demo-qemu_virt_aarch64-debug.
+The analyser combines three sources:
+
+  the PD ELFs          text, rodata, data and bss section sizes
+  report.txt           every page and kernel object the Microkit tool
+                       allocated: ELF, stack and IPC buffer pages, memory
+                       region pages, page tables and kernel objects
+  the system file      which PDs map each memory region
+
+into one row per PD. A region mapped by one PD counts towards that PD's
+private memory; one mapped by several is listed as shared under each of
+them and counted once in the total. Kernel object sizes come from the
+SDK's seL4 headers for the board.
+
+OLD and NEW are build directories or CSV files written by "report --csv",
+so a footprint can be kept next to the metrics of a run and compared with
+a later build, another config or another board. A CSV already has its
+regions split into private and shared, so it needs no system file. A
+build directory is read against the current tree's system file unless
+--old-sdf or --new-sdf names the one it was built from; a build from
+another revision should be diffed as a saved CSV or with its own file.
+With --threshold, diff exits 1 if any PD's total grew by more than PCT
+percent.
+
+With --hwm, report also reads the HWM|METRIC lines from a console log of
+a run (see microkit/lib/hwm.h) and lists, for each stack and region, the
+bytes mapped against the most the run used, i.e. how far each could
+shrink. A page is the smallest a region can be mapped with, so headroom
+within the last page cannot be given back.
+"""
+
+import argparse
+import csv
+import os
+import re
+import struct
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+PROJECT_ROOT = os.path.dirname(SCRIPT_DIR)
+DEFAULT_SDK = os.path.join(PROJECT_ROOT, 'microkit-sdk')
+
+COLUMNS = ['text', 'rodata', 'data', 'bss', 'elf_pages', 'stack', 'ipc_buffer',
+           'private_mr', 'shared_mr', 'page_tables', 'kernel_objects', 'total']
+
+# Used if the SDK headers cannot be preprocessed; the qemu_virt_aarch64 values
+DEFAULT_BITS = {'TCB': 11, 'Endpoint': 4, 'Notification': 6, 'Reply': 5,
+                'Slot': 5, 'PageTable': 12, 'VSpace': 13}
+
+# Fixed by the Microkit tool rather than the kernel
+PD_CAP_SLOTS = 512
+SCHED_CONTEXT_BYTES = 256
+
+OBJ_RE = re.compile(r'^\s{4}(\S.*?)\s{2,}\d+ cap_addr=')
+PAGE_SIZE_RE = re.compile(r'^Page\((\d+) ([KMG])iB\)$')
+UNITS = {'K': 1 << 10, 'M': 1 << 20, 'G': 1 << 30}
+HWM_RE = re.compile(r'HWM\|METRIC: pd=(\S+) region=(\S+) peak_bytes=(\d+)(?: touched_bytes=(\d+))?')
+
+
+def kernel_object_sizes(sdk, board, config):
+    """Sizes in bytes of the kernel objects the Microkit tool allocates"""
+    bits = dict(DEFAULT_BITS)
+    include = os.path.join(sdk, 'board', board, config, 'include')
+    source = '#include <sel4/config.h>\n#include <sel4/sel4_arch/constants.h>\n'
+    try:
+        out = subprocess.run(['cpp', '-dM', '-I', include, '-'], input=source,
+                             capture_output=True, text=True, check=True).stdout
+        defines = dict(re.findall(r'#define (seL4_\w+) (\S+)', out))
+
+        def resolve(name):
+            value = defines.get(name)
+            while value is not None and not value.isdigit():
+                value = defines.get(value)
+            return int(value) if value is not None else None
+
+        for key in bits:
+            value = resolve(f'seL4_{key}Bits')
+            if value is not None:
+                bits[key] = value
+    except (OSError, subprocess.CalledProcessError):
+        print(f"Warning: could not read seL4 constants from {include}; using defaults",
+              file=sys.stderr)
+
+    return {
+        'TCB': 1 << bits['TCB'],
+        'EP': 1 << bits['Endpoint'],
+        'Notification': 1 << bits['Notification'],
+        'Reply': 1 << bits['Reply'],
+        'SchedContext': SCHED_CONTEXT_BYTES,
+        'CNode': PD_CAP_SLOTS << bits['Slot'],
+        'PageTable': 1 << bits['PageTable'],
+        'VSpace': 1 << bits['VSpace'],
+    }
+
+
+def elf_sections(path):
+    """text/rodata/data/bss sizes of an ELF64, as binutils' size(1) groups them"""
+    sizes = {'text': 0, 'rodata': 0, 'data': 0, 'bss': 0}
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != b'\x7fELF' or data[4] != 2:
+        raise ValueError(f"{path}: not an ELF64 file")
+    endian = '<' if data[5] == 1 else '>'
+    shoff, = struct.unpack_from(endian + 'Q', data, 0x28)
+    shentsize, shnum = struct.unpack_from(endian + 'HH', data, 0x3a)
+
+    SHT_NOBITS = 8
+    SHF_WRITE, SHF_ALLOC, SHF_EXECINSTR = 0x1, 0x2, 0x4
+    for i in range(shnum):
+        _, sh_type, sh_flags, _, _, sh_size = struct.unpack_from(endian + 'IIQQQQ', data,
+                                                                 shoff + i * shentsize)
+        if not sh_flags & SHF_ALLOC:
+            continue
+        if sh_type == SHT_NOBITS:
+            sizes['bss'] += sh_size
+        elif sh_flags & SHF_EXECINSTR:
+            sizes['text'] += sh_size
+        elif sh_flags & SHF_WRITE:
+            sizes['data'] += sh_size
+        else:
+            sizes['rodata'] += sh_size
+    return sizes
+
+
+def parse_sdf(path):
+    """Return ({pd: program image}, {pd: [memory regions mapped]})"""
+    root = ET.parse(path).getroot()
+    images = {}
+    maps = {}
+    for pd in root.iter('protection_domain'):
+        name = pd.get('name')
+        image = pd.find('program_image')
+        if image is not None:
+            images[name] = image.get('path')
+        # Only this PD's own maps, not those of its children
+        maps[name] = [m.get('mr') for m in pd.findall('map')]
+    return images, maps
+
+
+def parse_report(path, sizes):
+    """Return ({pd: {column: bytes}}, {memory region: bytes})"""
+    per_pd = {}
+    regions = {}
+    in_detail = False
+
+    def add(pd, column, n):
+        per_pd.setdefault(pd, {}).setdefault(column, 0)
+        per_pd[pd][column] += n
+
+    with open(path) as f:
+        for line in f:
+            if line.startswith('# '):
+                in_detail = line.strip() == '# Allocated Kernel Objects Detail'
+                continue
+            if not in_detail:
+                continue
+            m = OBJ_RE.match(line)
+            if not m:
+                continue
+            kind, _, desc = m.group(1).partition(': ')
+            pd_match = re.search(r'PD=(\S+)', desc)
+            page = PAGE_SIZE_RE.match(kind)
+
+            if page:
+                size = int(page.group(1)) * UNITS[page.group(2)]
+                if desc.startswith('MR=ELF:'):
+                    add(desc[len('MR=ELF:'):].split()[0].rsplit('-', 1)[0], 'elf_pages', size)
+                elif desc.startswith('MR=STACK:'):
+                    add(desc[len('MR=STACK:'):].split()[0], 'stack', size)
+                elif desc.startswith('IPC Buffer') and pd_match:
+                    add(pd_match.group(1), 'ipc_buffer', size)
+                elif desc.startswith('MR='):
+                    mr = desc[len('MR='):].split()[0]
+                    regions[mr] = regions.get(mr, 0) + size
+            elif kind in ('PageTable', 'VSpace'):
+                add(pd_match.group(1) if pd_match else 'monitor', 'page_tables', sizes[kind])
+            elif kind in sizes:
+                add(pd_match.group(1) if pd_match else 'monitor', 'kernel_objects', sizes[kind])
+    return per_pd, regions
+
+
+def split_build_dir(build_dir):
+    """out/<app>-<board>-<config> -> (app, board, config)"""
+    name = os.path.basename(os.path.normpath(build_dir))
+    m = re.match(r'^(.*)-(qemu_virt_aarch64|qemu_virt_riscv64|[^-]+)-(debug|release|benchmark)$', name)
+    if not m:
+        raise ValueError(f"cannot tell app, board and config from {build_dir}; pass --sdf, --board and --config")
+    return m.groups()
+
+
+def footprint(build_dir, sdf=None, board=None, config=None, sdk=DEFAULT_SDK):
+    """Return ({pd: {column: bytes}} with a 'total' row, {memory region: bytes})"""
+    if sdf is None or board is None or config is None:
+        app, dir_board, dir_config = split_build_dir(build_dir)
+        sdf = sdf or os.path.join(PROJECT_ROOT, 'microkit', app, 'system.system')
+        board = board or dir_board
+        config = config or dir_config
+
+    sizes = kernel_object_sizes(sdk, board, config)
+    images, maps = parse_sdf(sdf)
+    per_pd, regions = parse_report(os.path.join(build_dir, 'report.txt'), sizes)
+
+    # A PD the Microkit tool allocated nothing for is not in this build
+    missing = [pd for pd in maps if pd not in per_pd]
+    if missing:
+        print(f"Warning: {sdf} has PDs that {build_dir} does not: {', '.join(missing)}; "
+              "pass the system file it was built from", file=sys.stderr)
+        maps = {pd: mrs for pd, mrs in maps.items() if pd in per_pd}
+
+    mappers = {}
+    for pd, mrs in maps.items():
+        for mr in set(mrs):
+            mappers.setdefault(mr, set()).add(pd)
+
+    rows = {}
+    for pd in list(maps) + sorted(set(per_pd) - set(maps)):
+        row = dict.fromkeys(COLUMNS, 0)
+        row.update(per_pd.get(pd, {}))
+        image = images.get(pd)
+        if image and os.path.exists(os.path.join(build_dir, image)):
+            row.update(elf_sections(os.path.join(build_dir, image)))
+        for mr in set(maps.get(pd, [])):
+            column = 'private_mr' if len(mappers[mr]) == 1 else 'shared_mr'
+            row[column] += regions.get(mr, 0)
+        row['total'] = sum(row[c] for c in ('elf_pages', 'stack', 'ipc_buffer', 'private_mr',
+                                             'page_tables', 'kernel_objects'))
+        rows[pd] = row
+
+    total = {c: sum(r[c] for r in rows.values()) for c in COLUMNS}
+    # Shared regions once, not once per PD that maps them
+    total['shared_mr'] = sum(size for mr, size in regions.items() if len(mappers.get(mr, ())) > 1)
+    total['total'] += total['shared_mr']
+    rows['total'] = total
+    return rows, regions
+
+
+def load(source, args, sdf):
+    """Footprint from a build directory or from a CSV written by report --csv"""
+    if os.path.isdir(source):
+        return footprint(source, sdf, args.board, args.config, args.sdk)[0]
+    rows = {}
+    with open(source) as f:
+        for r in csv.DictReader(f):
+            rows[r['pd']] = {c: int(r[c]) for c in COLUMNS}
+    return rows
+
+
+def print_table(rows):
+    width = max(len(pd) for pd in rows)
+    print(f"{'pd':<{width}} " + ' '.join(f"{c:>14}" for c in COLUMNS))
+    for pd, row in rows.items():
+        print(f"{pd:<{width}} " + ' '.join(f"{row[c]:>14}" for c in COLUMNS))
+
+
+def print_peaks(log, rows, regions):
+    """Mapped bytes against the HWM|METRIC peaks in a run's log"""
+    peaks = {}
+    with open(log, errors='replace') as f:
+        for line in f:
+            m = HWM_RE.search(line)
+            if m:
+                pd, region, peak, touched = m.group(1), m.group(2), int(m.group(3)), m.group(4)
+                # The logger reports each peak again when it grows; keep the last
+                peaks[(pd, region)] = (peak, int(touched) if touched else None)
+    if not peaks:
+        print(f"\nNo HWM|METRIC lines in {log}", file=sys.stderr)
+        return
+
+    print(f"\n{'pd':<12} {'region':<16} {'mapped':>10} {'peak':>10} {'touched':>10} {'headroom':>10}")
+    for (pd, region), (peak, touched) in peaks.items():
+        mapped = rows.get(pd, {}).get('stack', 0) if region == 'stack' else regions.get(region, 0)
+        touched = '-' if touched is None else touched
+        print(f"{pd:<12} {region:<16} {mapped:>10} {peak:>10} {touched:>10} {mapped - peak:>10}")
+
+
+def cmd_report(args):
+    rows, regions = footprint(args.build_dir, args.sdf, args.board, args.config, args.sdk)
+    print_table(rows)
+    if args.hwm:
+        print_peaks(args.hwm, rows, regions)
+    if args.csv:
+        with open(args.csv, 'w', newline='') as f:
+            writer = csv.writer(f)
+            writer.writerow(['pd'] + COLUMNS)
+            for pd, row in rows.items():
+                writer.writerow([pd] + [row[c] for c in COLUMNS])
+        print(f"\nFootprint saved to: {args.csv}", file=sys.stderr)
+    return 0
+
+
+def cmd_diff(args):
+    old = load(args.old, args, args.old_sdf or args.sdf)
+    new = load(args.new, args, args.new_sdf or args.sdf)
+    regressions = []
+    changed = False
+
+    print(f"{'pd':<16} {'column':<16} {'old':>12} {'new':>12} {'delta':>12} {'pct':>8}")
+    for pd in list(new) + [pd for pd in old if pd not in new]:
+        o = old.get(pd, dict.fromkeys(COLUMNS, 0))
+        n = new.get(pd, dict.fromkeys(COLUMNS, 0))
+        for c in COLUMNS:
+            if o[c] == n[c]:
+                continue
+            changed = True
+            delta = n[c] - o[c]
+            pct = f"{delta * 100.0 / o[c]:+.1f}%" if o[c] else 'new'
+            print(f"{pd:<16} {c:<16} {o[c]:>12} {n[c]:>12} {delta:>+12} {pct:>8}")
+            if (c == 'total' and args.threshold is not None and delta > 0 and
+                    (o[c] == 0 or delta * 100.0 / o[c] > args.threshold)):
+                regressions.append(pd)
+    if not changed:
+        print("No change")
+
+    if regressions:
+        print(f"\nFootprint regression over {args.threshold}%: {', '.join(regressions)}", file=sys.stderr)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Per-PD memory footprint of a Microkit build')
+    # Accepted after either command
+    build = argparse.ArgumentParser(add_help=False)
+    build.add_argument('--sdf', help='system file (default: microkit/<app>/system.system)')
+    build.add_argument('--board', help='board (default: from the build directory name)')
+    build.add_argument('--config', help='config (default: from the build directory name)')
+    build.add_argument('--sdk', default=DEFAULT_SDK, help='Microkit SDK (default: microkit-sdk)')
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    report = sub.add_parser('report', parents=[build], help='print the per-PD table of one build')
+    report.add_argument('build_dir')
+    report.add_argument('--csv', help='also write the table to this CSV file')
+    report.add_argument('--hwm', metavar='LOG', help='compare with the HWM|METRIC peaks in this console log')
+
+    diff = sub.add_parser('diff', parents=[build], help='compare two builds or saved CSVs')
+    diff.add_argument('old')
+    diff.add_argument('new')
+    diff.add_argument('--old-sdf', metavar='FILE', help='system file OLD was built from (default: --sdf)')
+    diff.add_argument('--new-sdf', metavar='FILE', help='system file NEW was built from (default: --sdf)')
+    diff.add_argument('--threshold', type=float, help='exit 1 if a total grows by more than PCT percent')
+
+    args = parser.parse_args()
+    try:
+        return cmd_report(args) if args.command == 'report' else cmd_diff(args)
+    except (OSError, ValueError, ET.ParseError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,56 @@
+#!/bin/bash
+#
+# Sweep irq_bench's priority relative to its background loads
+# Usage: ./irq_priority_sweep.sh [config] [priority...]
+#
+# Builds and runs irq_bench once for each priority (IRQ_BENCH_PRIORITY,
+# default 100 200 254) and collects every IRQBENCH|METRIC line with a
+# priority= field added, so the runs can be told apart. The loads sit at
+# 50 (spin_low, ipc_client), 60 (ipc_server) and 250 (spin_high), so keep
+# the priorities above 60.
+#
+
+set -e
+
+export PATH="/usr/bin:/bin:/usr/local/bin:$PATH"
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+CONFIG="${1:-release}"
+shift || true
+PRIORITIES="${*:-100 200 254}"
+BOARD=qemu_virt_aarch64
+
+SWEEP_DIR="$PROJECT_ROOT/out/irq_priority/$(date +%Y%m%d-%H%M)"
+RESULTS="$SWEEP_DIR/metrics.txt"
+mkdir -p "$SWEEP_DIR"
+: > "$RESULTS"
+
+echo "Sweeping irq_bench priority: $PRIORITIES"
+echo "Config: $CONFIG"
+echo "Results directory: $SWEEP_DIR"
+echo ""
+
+for PRIORITY in $PRIORITIES; do
+    echo "Priority $PRIORITY..."
+    IRQ_BENCH_PRIORITY="$PRIORITY" bash "$SCRIPT_DIR/build.sh" irq_bench "$BOARD" "$CONFIG" > "$SWEEP_DIR/build_$PRIORITY.log"
+
+    # irq_bench stops after its last load; QEMU does not, so bound the run
+    LOG_FILE="$SWEEP_DIR/run_$PRIORITY.log"
+    RUN_CMD=(bash "$SCRIPT_DIR/run.sh" irq_bench "$BOARD" "$CONFIG")
+    if command -v script > /dev/null 2>&1; then
+        timeout 120 script -q -c "${RUN_CMD[*]}" "$LOG_FILE" > /dev/null 2>&1 || true
+    else
+        timeout 120 "${RUN_CMD[@]}" > "$LOG_FILE" 2>&1 || true
+    fi
+
+    if ! grep -q "IRQBENCH|INFO: done" "$LOG_FILE"; then
+        echo "  Warning: run did not finish, see $LOG_FILE"
+    fi
+    grep -a "IRQBENCH|METRIC:" "$LOG_FILE" | tr -d '\r' \
+        | sed -e "s/IRQBENCH|METRIC: /IRQBENCH|METRIC: priority=$PRIORITY /" | tee -a "$RESULTS"
+    echo ""
+done
+
+echo "Results saved to: $RESULTS"
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""
+Load generator for the virtio_net packet pipeline running in QEMU
+Usage: ./net_loadgen.py [--direction outer|inner] [--size N] [--count N] [--rate PPS]
+
+QEMU's socket netdevs (see microkit/virtio_net/qemu_args) carry raw Ethernet
+frames in UDP datagrams on localhost. Frames sent into one NIC are forwarded
+by pass and come out of the other, so this script sends sequence-numbered
+frames into one side and times them out of the other.
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import threading
+import time
+
+# (QEMU listens on, QEMU sends to) for each NIC, matching qemu_args
+PORTS = {
+    'outer': (10001, 10000),
+    'inner': (10003, 10002),
+}
+
+ETHERTYPE = 0x88b5  # IEEE local experimental
+HEADER = struct.Struct('!6s6sHIQ')  # dst, src, ethertype, seq, send time (ns)
+MIN_FRAME = 60
+
+
+def build_frame(seq, size):
+    """Build one test frame of the given size (without FCS)"""
+    hdr = HEADER.pack(b'\x02\x00\x00\x00\x00\x02', b'\x02\x00\x00\x00\x00\x01',
+                      ETHERTYPE, seq, time.perf_counter_ns())
+    return hdr + bytes(size - len(hdr))
+
+
+def percentile(sorted_vals, pct):
+    if not sorted_vals:
+        return 0.0
+    idx = min(len(sorted_vals) - 1, int(len(sorted_vals) * pct / 100))
+    return sorted_vals[idx]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('--direction', choices=PORTS.keys(), default='outer',
+                        help='NIC to inject into; frames come out of the other one')
+    parser.add_argument('--size', type=int, default=64, help='frame size in bytes (60..1514)')
+    parser.add_argument('--count', type=int, default=100000, help='frames to send')
+    parser.add_argument('--rate', type=int, default=0, help='frames per second, 0 for as fast as possible')
+    parser.add_argument('--drain', type=float, default=1.0,
+                        help='seconds to keep receiving after the last frame is sent')
+    args = parser.parse_args()
+
+    if not MIN_FRAME <= args.size <= 1514:
+        print(f"Error: --size must be between {MIN_FRAME} and 1514", file=sys.stderr)
+        return 1
+
+    other = 'inner' if args.direction == 'outer' else 'outer'
+    qemu_rx_port = PORTS[args.direction][0]
+    qemu_tx_port = PORTS[other][1]
+
+    tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    rx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    rx.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 8 * 1024 * 1024)
+    rx.bind(('127.0.0.1', qemu_tx_port))
+    rx.settimeout(args.drain)
+
+    latencies = []
+    seen = set()
+    first_rx = [None]
+    last_rx = [None]
+    sending_done = threading.Event()
+
+    def receiver():
+        while True:
+            try:
+                data = rx.recv(2048)
+            except socket.timeout:
+                if sending_done.is_set():
+                    return
+                continue
+            now = time.perf_counter_ns()
+            if len(data) < HEADER.size:
+                continue
+            _, _, ethertype, seq, sent = HEADER.unpack_from(data)
+            if ethertype != ETHERTYPE or seq in seen:
+                continue
+            seen.add(seq)
+            latencies.append((now - sent) / 1000.0)
+            if first_rx[0] is None:
+                first_rx[0] = now
+            last_rx[0] = now
+
+    thread = threading.Thread(target=receiver)
+    thread.start()
+
+    interval = 1.0 / args.rate if args.rate else 0.0
+    start = time.perf_counter()
+    for seq in range(args.count):
+        if interval:
+            delay = start + seq * interval - time.perf_counter()
+            if delay > 0:
+                time.sleep(delay)
+        tx.sendto(build_frame(seq, args.size), ('127.0.0.1', qemu_rx_port))
+    send_secs = time.perf_counter() - start
+    sending_done.set()
+    thread.join()
+
+    received = len(seen)
+    rx_secs = (last_rx[0] - first_rx[0]) / 1e9 if received > 1 else 0.0
+    pps = received / rx_secs if rx_secs else 0.0
+    lat = sorted(latencies)
+
+    print(f"NETLOAD|INFO: sent {args.count} frames in {send_secs:.3f}s "
+          f"({args.count / send_secs:.0f} pps offered)")
+    print(f"NETLOAD|METRIC: direction={args.direction} size={args.size} sent={args.count} "
+          f"received={received} loss_pct={100.0 * (args.count - received) / args.count:.2f} "
+          f"pps={pps:.0f} mbps={pps * args.size * 8 / 1e6:.1f} "
+          f"lat_p50_us={percentile(lat, 50):.1f} lat_p99_us={percentile(lat, 99):.1f}")
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -9,45 +9,49 @@ set -e
 # Ensure basic PATH includes standard locations
 export PATH="/usr/bin:/bin:/usr/local/bin:/usr/sbin:$PATH"
 
-# Find QEMU - try multiple methods
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+APP_NAME="${1:-hello_world}"
+BOARD="${2:-qemu_virt_aarch64}"
+CONFIG="${3:-debug}"
+
+# Find QEMU for the board's architecture - try multiple methods
+case "$BOARD" in
+    qemu_virt_riscv64) QEMU_NAME="qemu-system-riscv64" ;;
+    *) QEMU_NAME="qemu-system-aarch64" ;;
+esac
 QEMU_BIN=""
 
 # Debug: check if file exists
-if [ -f "/usr/bin/qemu-system-aarch64" ]; then
-    if [ -x "/usr/bin/qemu-system-aarch64" ]; then
-        QEMU_BIN="/usr/bin/qemu-system-aarch64"
+if [ -f "/usr/bin/$QEMU_NAME" ]; then
+    if [ -x "/usr/bin/$QEMU_NAME" ]; then
+        QEMU_BIN="/usr/bin/$QEMU_NAME"
     else
-        echo "Warning: /usr/bin/qemu-system-aarch64 exists but is not executable"
-        chmod +x /usr/bin/qemu-system-aarch64 2>/dev/null || true
-        if [ -x "/usr/bin/qemu-system-aarch64" ]; then
-            QEMU_BIN="/usr/bin/qemu-system-aarch64"
+        echo "Warning: /usr/bin/$QEMU_NAME exists but is not executable"
+        chmod +x "/usr/bin/$QEMU_NAME" 2>/dev/null || true
+        if [ -x "/usr/bin/$QEMU_NAME" ]; then
+            QEMU_BIN="/usr/bin/$QEMU_NAME"
         fi
     fi
 fi
 
 # Fallback to command lookup
 if [ -z "$QEMU_BIN" ]; then
-    if command -v qemu-system-aarch64 > /dev/null 2>&1; then
-        QEMU_BIN=$(command -v qemu-system-aarch64)
+    if command -v "$QEMU_NAME" > /dev/null 2>&1; then
+        QEMU_BIN=$(command -v "$QEMU_NAME")
     fi
 fi
 
 # Final check
 if [ -z "$QEMU_BIN" ]; then
-    echo "Error: qemu-system-aarch64 not found"
+    echo "Error: $QEMU_NAME not found"
     echo "Please install QEMU: sudo apt install qemu-system-arm qemu-system-misc"
-    echo "Checking /usr/bin/qemu-system-aarch64:"
-    ls -la /usr/bin/qemu-system-aarch64 2>&1 || echo "File does not exist"
+    echo "Checking /usr/bin/$QEMU_NAME:"
+    ls -la "/usr/bin/$QEMU_NAME" 2>&1 || echo "File does not exist"
     exit 1
 fi
 
-SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
-PROJECT_ROOT="$(cd "$SCRIPT_DIR/.." && pwd)"
-
-APP_NAME="${1:-hello_world}"
-BOARD="${2:-qemu_virt_aarch64}"
-CONFIG="${3:-debug}"
-
 BUILD_DIR="$PROJECT_ROOT/out/$APP_NAME-$BOARD-$CONFIG"
 IMAGE_FILE="$BUILD_DIR/loader.img"
 
@@ -57,6 +61,20 @@ if [ ! -f "$IMAGE_FILE" ]; then
     exit 1
 fi
 
+# Extra QEMU arguments an application needs (devices, netdevs, disks), if any.
+# $BUILD_DIR in the file expands to this build's output directory.
+QEMU_EXTRA_ARGS=()
+QEMU_ARGS_FILE="$PROJECT_ROOT/microkit/$APP_NAME/qemu_args"
+if [ -f "$QEMU_ARGS_FILE" ]; then
+    while read -r line; do
+        case "$line" in
+            ""|"#"*) continue ;;
+        esac
+        line="${line//\$BUILD_DIR/$BUILD_DIR}"
+        QEMU_EXTRA_ARGS+=($line)
+    done < "$QEMU_ARGS_FILE"
+fi
+
 echo "Running $APP_NAME on $BOARD"
 echo "Image: $IMAGE_FILE"
 echo "Press Ctrl+A then X to exit QEMU"
@@ -70,15 +88,18 @@ case "$BOARD" in
             -serial mon:stdio \
             -m 2048M \
             -kernel "$IMAGE_FILE" \
-            -no-reboot
+            -no-reboot \
+            "${QEMU_EXTRA_ARGS[@]}"
         ;;
     qemu_virt_riscv64)
-        qemu-system-riscv64 -machine virt \
+        # The board's memory runs from 0x80200000 to 4 GiB (platform_gen.json)
+        "$QEMU_BIN" -machine virt \
             -cpu rv64 \
             -nographic \
             -serial mon:stdio \
-            -m size=1024M \
-            -kernel "$IMAGE_FILE"
+            -m size=2G \
+            -kernel "$IMAGE_FILE" \
+            "${QEMU_EXTRA_ARGS[@]}"
         ;;
     *)
         echo "Error: Unsupported board: $BOARD"
@@ -40,8 +40,13 @@ if [ ! -f "$IMAGE_FILE" ]; then
     "$SCRIPT_DIR/build.sh" "$APP_NAME" "$BOARD" "$CONFIG"
 fi
 
-# Initialize CSV file
-echo "iteration,latency_ns,timestamp" > "$RESULTS_CSV"
+case "$BOARD" in
+    qemu_virt_riscv64) QEMU_NAME="qemu-system-riscv64" ;;
+    *) QEMU_NAME="qemu-system-aarch64" ;;
+esac
+
+# Initialize CSV file; ppcall_avg_ns is the mean of the client's null-call loop
+echo "iteration,latency_ns,timestamp,ppcall_avg_ns" > "$RESULTS_CSV"
 
 echo "Running $ITERATIONS iterations..."
 for i in $(seq 1 $ITERATIONS); do
@@ -51,9 +56,9 @@ for i in $(seq 1 $ITERATIONS); do
     LOG_FILE="$RESULTS_DIR/run_${i}.log"
     
     # Check if QEMU is available
-    if ! command -v qemu-system-aarch64 > /dev/null 2>&1; then
-        echo "  ERROR: qemu-system-aarch64 not found in PATH"
-        echo "  Please install QEMU: sudo apt install qemu-system-arm"
+    if ! command -v "$QEMU_NAME" > /dev/null 2>&1; then
+        echo "  ERROR: $QEMU_NAME not found in PATH"
+        echo "  Please install QEMU: sudo apt install qemu-system-arm qemu-system-misc"
         exit 1
     fi
     
@@ -106,7 +111,7 @@ EOF
         echo "  Debug: Command was: ${RUN_CMD[*]}"
     fi
     
-    if grep -q "Error: qemu-system-aarch64 not found" "$LOG_FILE"; then
+    if grep -q "Error: $QEMU_NAME not found" "$LOG_FILE"; then
         cat "$LOG_FILE"
         exit 1
     fi
@@ -136,9 +141,11 @@ EOF
         echo "  Debug: Log file size: $(wc -l < "$LOG_FILE" 2>/dev/null || echo 0) lines"
     fi
     
+    PPCALL_AVG=$(grep -oE "ppcall_avg_ns=[0-9]+" "$LOG_FILE" 2>/dev/null | grep -oE "[0-9]+" | head -1 || echo "")
+
     if [ -n "$LATENCY" ]; then
-        echo "$i,$LATENCY,$(date +%s)" >> "$RESULTS_CSV"
-        echo "  Latency: $LATENCY ns"
+        echo "$i,$LATENCY,$(date +%s),$PPCALL_AVG" >> "$RESULTS_CSV"
+        echo "  Latency: $LATENCY ns${PPCALL_AVG:+, ppcall average: $PPCALL_AVG ns}"
     else
         echo "  Warning: Could not extract latency"
     fi
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""
+Convert the TRACE|EVENT lines of a captured serial log to Chrome trace JSON
+Usage: ./trace_to_chrome.py [log_file] [output_json]
+
+Build the application with TRACE=1 (see microkit/lib/trace.h), capture its
+output with capture_logs.sh, and open the result in chrome://tracing or
+https://ui.perfetto.dev. Each PD becomes one thread of a single process,
+so its spans nest on one track and the tracks line up on the PDs' shared
+counter. Reads stdin and writes stdout when no files are given.
+"""
+
+import json
+import re
+import sys
+
+EVENT_RE = re.compile(r'TRACE\|EVENT: pd=(\S+) ph=([BEi]) ts_ns=(\d+) name=(\S+)')
+DROPPED_RE = re.compile(r'TRACE\|WARN: pd=(\S+) dropped=(\d+)')
+
+PID = 1
+
+
+def convert(lines):
+    """Return (trace dict, dropped events per PD) for the given log lines"""
+    tids = {}
+    events = []
+    dropped = {}
+
+    for line in lines:
+        m = EVENT_RE.search(line)
+        if m:
+            pd, phase, ts_ns, name = m.groups()
+            tid = tids.setdefault(pd, len(tids) + 1)
+            event = {
+                'name': name,
+                'ph': phase,
+                'ts': int(ts_ns) / 1000.0,  # Chrome traces are in microseconds
+                'pid': PID,
+                'tid': tid,
+            }
+            if phase == 'i':
+                event['s'] = 't'  # Instant scoped to its thread
+            events.append(event)
+            continue
+        m = DROPPED_RE.search(line)
+        if m:
+            dropped[m.group(1)] = dropped.get(m.group(1), 0) + int(m.group(2))
+
+    metadata = [{'name': 'process_name', 'ph': 'M', 'pid': PID, 'args': {'name': 'seL4 Microkit'}}]
+    for pd, tid in tids.items():
+        metadata.append({'name': 'thread_name', 'ph': 'M', 'pid': PID, 'tid': tid, 'args': {'name': pd}})
+        metadata.append({'name': 'thread_sort_index', 'ph': 'M', 'pid': PID, 'tid': tid,
+                         'args': {'sort_index': tid}})
+
+    return {'traceEvents': metadata + events, 'displayTimeUnit': 'ns'}, dropped
+
+
+def main():
+    if len(sys.argv) > 3:
+        print(__doc__.strip(), file=sys.stderr)
+        return 1
+
+    try:
+        if len(sys.argv) > 1:
+            with open(sys.argv[1], 'r', errors='replace') as f:
+                trace, dropped = convert(f)
+        else:
+            trace, dropped = convert(sys.stdin)
+    except OSError as e:
+        print(f"Error reading log: {e}", file=sys.stderr)
+        return 1
+
+    count = sum(1 for e in trace['traceEvents'] if e['ph'] != 'M')
+    if count == 0:
+        print("No TRACE|EVENT lines found; was the application built with TRACE=1?", file=sys.stderr)
+        return 1
+
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], 'w') as f:
+            json.dump(trace, f)
+        print(f"Wrote {count} events to {sys.argv[2]}", file=sys.stderr)
+    else:
+        json.dump(trace, sys.stdout)
+        sys.stdout.write('\n')
+
+    for pd, n in dropped.items():
+        print(f"Warning: {pd} dropped {n} events (trace buffer full)", file=sys.stderr)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())